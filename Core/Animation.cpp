@@ -0,0 +1,75 @@
+#include "pch.h"
+#include "Animation.h"
+using namespace std;
+
+// 学生在动画名单中的位置，不在时追加
+static int ArenaIndex(Animation& animation, int student)
+{
+    if (animation.arenaStamp[student] != animation.stamp)
+    {
+        animation.arenaStamp[student] = animation.stamp;
+        animation.arenaOf[student] = static_cast<int>(animation.students.size());
+        animation.students.push_back(student);
+    }
+    return animation.arenaOf[student];
+}
+
+void BuildAnimation(const RandomEngine& engine, const vector<int>& picked, int frames, int durationMs,
+    Animation& animation, RandomStream& gen)
+{
+    size_t n = engine.Size();
+    size_t number = picked.size();
+    if (animation.arenaStamp.size() != n)
+    {
+        animation.arenaStamp.assign(n, 0);
+        animation.arenaOf.resize(n);
+        animation.stamp = 0;
+    }
+    if (++animation.stamp == 0)
+    {
+        fill(animation.arenaStamp.begin(), animation.arenaStamp.end(), 0);
+        animation.stamp = 1;
+    }
+    animation.students.clear();
+    for (int student : picked)
+        ArenaIndex(animation, student);
+
+    // 从末帧往前生成：末帧为结果，其余每帧每个位置与后一帧不同、同一帧内互不相同（人数不够时只保证前者）
+    animation.slots.resize(static_cast<size_t>(frames) * number);
+    for (size_t s = 0; s < number; s++)
+        animation.slots[(frames - 1) * number + s] = static_cast<int>(s);
+    for (int f = frames - 2; f >= 0; f--)
+    {
+        int* frame = animation.slots.data() + f * number;
+        const int* after = frame + number;
+        for (size_t s = 0; s < number; s++)
+        {
+            // 在排除后一帧同位置与本帧已填位置的候选中均匀选取：按升序跳过被排除的下标，不必重试
+            vector<int>& excluded = animation.excluded;
+            excluded.clear();
+            excluded.push_back(animation.students[after[s]]);
+            for (size_t t = 0; t < s; t++)
+                excluded.push_back(animation.students[frame[t]]);
+            sort(excluded.begin(), excluded.end());
+            excluded.erase(unique(excluded.begin(), excluded.end()), excluded.end());
+            if (excluded.size() >= n)
+            {
+                // 人数不够时只保证与后一帧同位置不同（仅一人时无从避免）
+                excluded.assign(1, animation.students[after[s]]);
+                if (n == 1) excluded.clear();
+            }
+            int student = static_cast<int>(gen.Below(n - excluded.size()));
+            for (int e : excluded)
+                if (student >= e) student++;
+            frame[s] = ArenaIndex(animation, student);
+        }
+    }
+
+    // 缓出（二次）：第 f 帧在进度 p = f / (frames - 1) 处出现，时刻 u 满足 1 - (1 - u)² = p
+    animation.times.resize(frames);
+    for (int f = 0; f < frames; f++)
+    {
+        double p = frames > 1 ? static_cast<double>(f) / (frames - 1) : 1.0;
+        animation.times[f] = static_cast<int>(lround(durationMs * (1.0 - sqrt(1.0 - p))));
+    }
+}
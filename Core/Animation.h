@@ -0,0 +1,24 @@
+// 滚动点名动画：抽取结果之外预先生成每一帧显示的学生与显示时刻，界面每帧只需按下标取姓名
+// 帧内容是“动画名单”中的下标：前 number 项为抽取结果，其后是动画中出现过的其他学生，每人只出现一次，
+// 因此姓名只需传递一次；末帧即抽取结果，其余每帧每个位置都与后一帧同位置不同（全体只有一人时除外），
+// 人数足够时同一帧内也互不相同
+
+#pragma once
+#include "RandomEngine.h"
+
+struct Animation
+{
+    std::vector<int> students;      // 动画名单：学生下标，前 number 项为抽取结果
+    std::vector<int> slots;         // 第 f 帧第 s 个位置显示 students[slots[f * number + s]]
+    std::vector<int> times;         // 第 f 帧开始显示的时刻（毫秒），缓出：越往后间隔越长，末帧在 durationMs
+
+    // 以下为生成时复用的临时数组，不必每次分配
+    std::vector<int> arenaOf;       // 学生在动画名单中的位置，arenaStamp 等于 stamp 时有效
+    std::vector<uint32_t> arenaStamp;
+    std::vector<int> excluded;      // 选取某个位置时被排除的学生，升序
+    uint32_t stamp = 0;
+};
+
+// 为已抽中的 picked 生成 frames 帧、共 durationMs 毫秒的动画（frames ≥ 1），诱饵在全体学生中均匀选取
+void BuildAnimation(const RandomEngine& engine, const std::vector<int>& picked, int frames, int durationMs,
+    Animation& animation, RandomStream& gen);
@@ -0,0 +1,857 @@
+// Core 基准测试：名单导入、抽取与 TOTP 热点路径
+// 用法：ic_core_bench [--filter 子串] [--quick] [--min-time 秒] [--out 结果.json] [--compare 基线.json]
+// 结果以 JSON 输出，带 --compare 时逐项打印与基线的耗时变化，便于在两次提交之间比较
+
+#include "Exports.h"
+#include "TOTP.h"
+#include "Trace.h"
+#include "Log.h"
+#include "Metrics.h"
+#include "RandomEngine.h"
+#include "UnionRoster.h"
+#include "RosterAlgebra.h"
+#include "Rng.h"
+#include "EntropyPool.h"
+#include "VerifiableSession.h"
+#include <cstdlib>
+#include <functional>
+#include <map>
+#ifndef _WIN32
+#include <sys/utsname.h>
+#include <unistd.h>
+#endif
+using namespace std;
+using Clock = chrono::steady_clock;
+
+struct BenchResult
+{
+    string name;
+    uint64_t iterations = 0;
+    double nsPerOpMedian = 0;
+    double nsPerOpMin = 0;
+    double bytesPerOp = 0; // 非零时额外输出吞吐量
+};
+
+struct BenchOptions
+{
+    string filter;
+    bool quick = false;
+    double minTime = 0.2; // 每个样本的最短时长（秒）
+    int samples = 5;
+    string outPath;
+    string comparePath;
+};
+
+static BenchOptions options;
+static vector<BenchResult> results;
+static string benchHome;
+
+// ---------- 合成名单 ----------
+
+enum class NameStyle { Ascii, Cjk, Quoted };
+
+static const char* StyleName(NameStyle style)
+{
+    switch (style)
+    {
+    case NameStyle::Ascii: return "ascii";
+    case NameStyle::Cjk: return "cjk";
+    default: return "quoted";
+    }
+}
+
+// 生成 rows 行的名单 CSV（ID,Name,Gender），名字不重复，固定种子保证各次提交之间输入一致
+static string GenerateRoster(size_t rows, NameStyle style)
+{
+    static const char* surnames[] = { "王", "李", "张", "刘", "陈", "杨", "黄", "赵", "吴", "周", "徐", "孙", "马", "朱", "胡", "郭" };
+    static const char* given[] = { "伟", "芳", "娜", "敏", "静", "丽", "强", "磊", "军", "洋", "勇", "艳", "杰", "涛", "明", "超", "秀", "霞", "平", "刚" };
+    mt19937_64 gen(42);
+    string csv = "ID,Name,Gender\r\n"; // Excel 导出的 CSV 使用 CRLF
+    csv.reserve(rows * 24);
+    for (size_t i = 0; i < rows; i++)
+    {
+        string name;
+        switch (style)
+        {
+        case NameStyle::Ascii:
+            name = "Student" + to_string(i);
+            break;
+        case NameStyle::Cjk:
+        {
+            name = surnames[gen() % 16];
+            name += given[gen() % 20];
+            // 用序号编码的后缀保证唯一，同时保持全部为 CJK 字符
+            for (size_t v = i; ; v /= 20)
+            {
+                name += given[v % 20];
+                if (v < 20) break;
+            }
+            break;
+        }
+        case NameStyle::Quoted:
+            name = "\" " + string(surnames[gen() % 16]) + "Student" + to_string(i) + " \"";
+            break;
+        }
+        csv += to_string(i + 1) + "," + name + "," + to_string(gen() % 2) + "\r\n";
+    }
+    return csv;
+}
+
+static string WriteRoster(const string& profile, const string& csv)
+{
+    ofstream file(Platform::GetProfilePath(profile + ".csv"), ios::binary);
+    file << csv;
+    return profile;
+}
+
+static wstring Wide(const string& s)
+{
+    return wstring(s.begin(), s.end());
+}
+
+// ---------- 计时 ----------
+
+static bool Selected(const string& name)
+{
+    return options.filter.empty() || name.find(options.filter) != string::npos;
+}
+
+// body(n) 执行 n 次操作并返回其中实际计时的纳秒数（允许在内部排除准备工作的耗时）
+static void RunTimed(const string& name, const function<double(uint64_t)>& body, double bytesPerOp = 0, uint64_t maxIterations = UINT64_MAX)
+{
+    if (!Selected(name)) return;
+
+    // 预热并估算单次耗时
+    uint64_t n = 1;
+    double elapsed = body(n);
+    while (elapsed < options.minTime * 1e9 / 10 && n < maxIterations)
+    {
+        n = min(maxIterations, n * 4);
+        elapsed = body(n);
+    }
+    uint64_t iterations = max<uint64_t>(1, min<uint64_t>(maxIterations, static_cast<uint64_t>(options.minTime * 1e9 / max(elapsed / n, 1.0))));
+
+    vector<double> perOp;
+    for (int s = 0; s < options.samples; s++)
+        perOp.push_back(body(iterations) / iterations);
+    sort(perOp.begin(), perOp.end());
+
+    BenchResult r;
+    r.name = name;
+    r.iterations = iterations;
+    r.nsPerOpMedian = perOp[perOp.size() / 2];
+    r.nsPerOpMin = perOp.front();
+    r.bytesPerOp = bytesPerOp;
+    results.push_back(r);
+    cerr << left << setw(44) << name << right << setw(14) << fixed << setprecision(1) << r.nsPerOpMedian << " ns/op\n";
+}
+
+static double Measure(const function<void()>& op, uint64_t n)
+{
+    auto start = Clock::now();
+    for (uint64_t i = 0; i < n; i++) op();
+    return chrono::duration<double, nano>(Clock::now() - start).count();
+}
+
+// ---------- 基准项 ----------
+
+static void BenchImport()
+{
+    vector<size_t> sizes = { 100, 1000, 10000, 100000, 1000000 };
+    if (options.quick) sizes.pop_back();
+    for (NameStyle style : { NameStyle::Ascii, NameStyle::Cjk, NameStyle::Quoted })
+    {
+        for (size_t rows : sizes)
+        {
+            string name = string("import/") + StyleName(style) + "/" + to_string(rows);
+            if (!Selected(name)) continue;
+            string csv = GenerateRoster(rows, style);
+            wstring profile = Wide(WriteRoster("bench_import", csv));
+            RunTimed(name, [&](uint64_t n) {
+                return Measure([&] { RandomImport(profile.c_str()); }, n);
+            }, static_cast<double>(csv.size()), rows >= 100000 ? 3 : UINT64_MAX);
+        }
+    }
+}
+
+// 在给定历史填充率下测量 SimpleRandom(k)
+// 每批抽取前先清空历史并预抽到目标填充率（不计时），批大小足够小以保证填充率基本不变
+static void BenchDraw()
+{
+    vector<size_t> sizes = { 60, 1000, 100000 };
+    if (options.quick) sizes.pop_back();
+    for (size_t rows : sizes)
+    {
+        wstring profile = Wide(WriteRoster("bench_draw", GenerateRoster(rows, NameStyle::Cjk)));
+        bool imported = false;
+        for (int k : { 1, 5 })
+        {
+            for (int fillPercent : { 0, 50, 90, 99 })
+            {
+                string name = "draw/k" + to_string(k) + "/" + to_string(rows) + "/fill" + to_string(fillPercent);
+                if (!Selected(name)) continue;
+                if (!imported) { RandomImport(profile.c_str()); imported = true; }
+                size_t fill = rows * fillPercent / 100;
+                if (rows - fill < static_cast<size_t>(k)) continue;
+                uint64_t batch = max<uint64_t>(1, min<uint64_t>(64, (rows - fill) / (4 * k)));
+                RunTimed(name, [&](uint64_t n) {
+                    double total = 0;
+                    for (uint64_t done = 0; done < n; done += batch)
+                    {
+                        ClearHistory();
+                        if (fill > 0) Platform::FreeString(SimpleRandom(static_cast<int>(fill)));
+                        uint64_t count = min(batch, n - done);
+                        total += Measure([&] { Platform::FreeString(SimpleRandom(k)); }, count);
+                    }
+                    return total;
+                });
+            }
+        }
+    }
+}
+
+// 滚动动画：导出函数一次调用完成抽取、生成 frames 帧诱饵与缓出时刻并输出动画名单；每抽满一轮清空一次
+static void BenchAnimation()
+{
+    wstring profile = Wide(WriteRoster("bench_animation", GenerateRoster(60, NameStyle::Cjk)));
+    bool imported = false;
+    for (int number : { 1, 5 })
+    {
+        for (int frames : { 30, 120 })
+        {
+            string name = "animation/k" + to_string(number) + "/60/frames" + to_string(frames);
+            if (!Selected(name)) continue;
+            if (!imported) { RandomImport(profile.c_str()); imported = true; }
+            vector<int> slots(frames * number), times(frames);
+            RunTimed(name, [&](uint64_t n) {
+                return Measure([&] {
+                    BSTR names = nullptr;
+                    if (AnimatedRandom(number, frames, 1500, slots.data(), times.data(), &names) != 0) ClearHistory();
+                    Platform::FreeString(names);
+                }, n);
+            });
+        }
+    }
+}
+
+// 直接调用抽取引擎（固定种子的随机数流），排除导出层的播种与字符串开销，只看抽取算法本身
+static void BenchDrawKernel()
+{
+    vector<size_t> sizes = { 60, 1000, 100000 };
+    if (options.quick) sizes.pop_back();
+    for (size_t rows : sizes)
+    {
+        RandomEngine engine;
+        vector<string> names(rows);
+        for (size_t i = 0; i < rows; i++) names[i] = "S" + to_string(i);
+        engine.Load(names);
+        RandomStream gen(12345);
+        vector<int> picked;
+        // 带 /cooldown8 后缀的项开启最近 8 人次冷却
+        for (size_t cooldown : { 0, 8 })
+        {
+            engine.SetCooldown(cooldown);
+            string suffix = cooldown ? "/cooldown" + to_string(cooldown) : "";
+            for (int k : { 1, 2, 3, 5, 8 })
+            {
+                for (int fillPercent : { 0, 50, 90 })
+                {
+                    string name = "draw_kernel/k" + to_string(k) + "/" + to_string(rows) + "/fill" + to_string(fillPercent) + suffix;
+                    if (!Selected(name)) continue;
+                    size_t fill = rows * fillPercent / 100;
+                    uint64_t batch = max<uint64_t>(1, min<uint64_t>(64, (rows - fill) / (4 * k)));
+                    RunTimed(name, [&](uint64_t n) {
+                        double total = 0;
+                        for (uint64_t done = 0; done < n; done += batch)
+                        {
+                            engine.ClearHistory();
+                            if (fill > 0) engine.Draw(static_cast<int>(fill), picked, gen);
+                            uint64_t count = min(batch, n - done);
+                            total += Measure([&] { engine.Draw(k, picked, gen); }, count);
+                        }
+                        return total;
+                    });
+                }
+            }
+        }
+    }
+}
+
+// 分层抽取：60 组每组抽一人，对照同一名单上连续 60 次单人抽取；每 10 次（约抽走三分之一）清空一次历史（不计时）
+// 随机数流：每次生成 4 KiB（与 mt19937_64 对照），经 RandomStream 转发的两种模式，
+// 分出新流的开销（快速模式为一次 2^128 步跳跃），以及两种模式下单人抽取的代价
+static void BenchRng()
+{
+    vector<uint64_t> block(512);
+    auto fill = [&](auto& gen) {
+        for (uint64_t& word : block) word = gen();
+    };
+    Xoshiro256 xoshiro(12345);
+    RunTimed("rng/xoshiro256/4KiB", [&](uint64_t n) {
+        return Measure([&] { fill(xoshiro); }, n);
+    }, 4096);
+    ChaCha20 chacha({ 1, 2, 3, 4, 5, 6, 7, 8 }, 0);
+    RunTimed("rng/chacha20/4KiB", [&](uint64_t n) {
+        return Measure([&] { fill(chacha); }, n);
+    }, 4096);
+    mt19937_64 reference(12345);
+    RunTimed("rng/mt19937_64/4KiB", [&](uint64_t n) {
+        return Measure([&] { fill(reference); }, n);
+    }, 4096);
+    RandomStream streams[2] = { RandomStream(xoshiro), RandomStream(chacha) };
+    const char* modes[2] = { "fast", "secure" };
+    for (int m = 0; m < 2; m++)
+    {
+        RunTimed(string("rng/stream_") + modes[m] + "/4KiB", [&](uint64_t n) {
+            return Measure([&] { fill(streams[m]); }, n);
+        }, 4096);
+    }
+    // 32 字节系统随机数：经熵池（线程块）与每次直接读取系统熵源对照
+    uint8_t key[32];
+    RunTimed("rng/entropy_pool/32B", [&](uint64_t n) {
+        return Measure([&] { Entropy::Fill(key, sizeof(key)); }, n);
+    }, 32);
+    RunTimed("rng/entropy_os/32B", [&](uint64_t n) {
+        return Measure([&] { Platform::GenRandom(key, sizeof(key)); }, n);
+    }, 32);
+    RunTimed("rng/jump", [&](uint64_t n) {
+        return Measure([&] { xoshiro.Jump(); }, n);
+    });
+    for (int m = 0; m < 2; m++)
+    {
+        RunTimed(string("rng/new_stream_") + modes[m], [&](uint64_t n) {
+            return Measure([&] { block[0] ^= Rng::NewStream(static_cast<RandomMode>(m))(); }, n);
+        });
+    }
+
+    RandomEngine engine;
+    vector<string> names(60);
+    for (size_t i = 0; i < names.size(); i++) names[i] = "S" + to_string(i);
+    engine.Load(names);
+    vector<int> picked;
+    for (int m = 0; m < 2; m++)
+    {
+        RunTimed(string("rng/draw_k1/60/") + modes[m], [&](uint64_t n) {
+            return Measure([&] {
+                if (engine.HistorySize() + 1 > names.size() / 2) engine.ClearHistory();
+                engine.Draw(1, picked, streams[m]);
+            }, n);
+        });
+    }
+}
+
+static void BenchStratified()
+{
+    const int groups = 60;
+    vector<int> perGroup = { 30 };
+    if (!options.quick) perGroup.push_back(1000);
+    for (int size : perGroup)
+    {
+        size_t rows = static_cast<size_t>(groups) * size;
+        RandomEngine engine;
+        vector<string> names(rows), groupNames(rows);
+        for (size_t i = 0; i < rows; i++)
+        {
+            names[i] = "S" + to_string(i);
+            groupNames[i] = "G" + to_string(i % groups);
+        }
+        engine.Load(names, groupNames);
+        RandomStream gen(12345);
+        vector<int> picked;
+        string suffix = "/" + to_string(groups) + "x" + to_string(size);
+        auto run = [&](const string& name, auto body) {
+            if (!Selected(name)) return;
+            RunTimed(name, [&](uint64_t n) {
+                double total = 0;
+                for (uint64_t done = 0; done < n; done += 10)
+                {
+                    engine.ClearHistory();
+                    total += Measure(body, min<uint64_t>(10, n - done));
+                }
+                return total;
+            });
+        };
+        run("draw_stratified/one_per_group" + suffix, [&] { engine.DrawStratified(StratifyMode::OnePerGroup, 0, picked, gen); });
+        run("draw_stratified/proportional" + suffix, [&] { engine.DrawStratified(StratifyMode::Proportional, groups, picked, gen); });
+        run("draw_stratified/single_x60" + suffix, [&] { for (int g = 0; g < groups; g++) engine.Draw(1, picked, gen); });
+    }
+}
+
+// 按座位抽取：方形座位表上抽 4 名互不相邻的学生、抽一人及其周围的同学，每 10 次清空一次历史（不计时）
+static void BenchSpatial()
+{
+    vector<int> sides = { 8, 100 };
+    if (options.quick) sides.pop_back();
+    for (int side : sides)
+    {
+        size_t rows = static_cast<size_t>(side) * side;
+        RandomEngine engine;
+        vector<string> names(rows);
+        vector<Seat> seats(rows);
+        for (size_t i = 0; i < rows; i++)
+        {
+            names[i] = "S" + to_string(i);
+            seats[i] = { static_cast<int>(i) / side, static_cast<int>(i) % side };
+        }
+        engine.Load(names, {}, seats);
+        RandomStream gen(12345);
+        vector<int> picked;
+        for (SpatialMode mode : { SpatialMode::NonAdjacent, SpatialMode::Cluster })
+        {
+            string name = string(mode == SpatialMode::NonAdjacent ? "draw_spatial/non_adjacent_k4/" : "draw_spatial/cluster/") + to_string(rows);
+            if (!Selected(name)) continue;
+            RunTimed(name, [&](uint64_t n) {
+                double total = 0;
+                for (uint64_t done = 0; done < n; done += 10)
+                {
+                    engine.ClearHistory();
+                    total += Measure([&] { engine.DrawSpatial(mode, 4, picked, gen); }, min<uint64_t>(10, n - done));
+                }
+                return total;
+            });
+        }
+    }
+}
+
+// 清空已抽取历史的开销：每次先把整轮抽满（不计时），再计时一次 ClearHistory
+static void BenchClear()
+{
+    vector<size_t> sizes = { 60, 1000, 100000 };
+    if (options.quick) sizes.pop_back();
+    for (size_t rows : sizes)
+    {
+        string name = "history/clear/" + to_string(rows);
+        if (!Selected(name)) continue;
+        RandomEngine engine;
+        vector<string> names(rows);
+        for (size_t i = 0; i < rows; i++) names[i] = "S" + to_string(i);
+        engine.Load(names);
+        RandomStream gen(12345);
+        vector<int> picked;
+        RunTimed(name, [&](uint64_t n) {
+            double total = 0;
+            for (uint64_t i = 0; i < n; i++)
+            {
+                engine.Draw(static_cast<int>(rows), picked, gen);
+                total += Measure([&] { engine.ClearHistory(); }, 1);
+            }
+            return total;
+        }, 0, max<uint64_t>(16, 4000000 / rows)); // 每次都要重新抽满，限制迭代次数
+    }
+}
+
+// 撤销 + 重做同一次抽取的开销，与名单规模无关，只与该次抽中人数有关
+static void BenchUndo()
+{
+    vector<size_t> sizes = { 1000, 100000 };
+    if (options.quick) sizes.pop_back();
+    for (size_t rows : sizes)
+    {
+        RandomEngine engine;
+        vector<string> names(rows);
+        for (size_t i = 0; i < rows; i++) names[i] = "S" + to_string(i);
+        engine.Load(names);
+        RandomStream gen(12345);
+        vector<int> picked;
+        for (int k : { 1, 8 })
+        {
+            string name = "history/undo_redo/k" + to_string(k) + "/" + to_string(rows);
+            if (!Selected(name)) continue;
+            engine.ClearHistory();
+            engine.Draw(k, picked, gen);
+            RunTimed(name, [&](uint64_t n) {
+                return Measure([&] { engine.Undo(picked); engine.Redo(picked); }, n);
+            });
+        }
+    }
+}
+
+// 状态快照的保存与恢复（含 CRC32 校验），历史填充一半
+static void BenchState()
+{
+    vector<size_t> sizes = { 1000, 10000 };
+    if (!options.quick) sizes.push_back(100000);
+    for (size_t rows : sizes)
+    {
+        RandomEngine engine;
+        vector<string> names(rows);
+        for (size_t i = 0; i < rows; i++) names[i] = "S" + to_string(i);
+        engine.Load(names);
+        RandomStream gen(12345);
+        vector<int> picked;
+        engine.Draw(static_cast<int>(rows / 2), picked, gen);
+        string state;
+        engine.SaveState(state);
+        RunTimed("state/save/" + to_string(rows), [&](uint64_t n) {
+            return Measure([&] { engine.SaveState(state); }, n);
+        }, static_cast<double>(state.size()));
+        RunTimed("state/load/" + to_string(rows), [&](uint64_t n) {
+            return Measure([&] { engine.LoadState(state); }, n);
+        }, static_cast<double>(state.size()));
+    }
+}
+
+// 可验证抽取：每次课间切换时开始与揭示一次会话（含快照与 SHA-256 承诺值），
+// 以及一节课 40 次单人抽取的记录与离线重放，60 人名单
+static void BenchSession()
+{
+    RandomEngine engine;
+    vector<string> names(60);
+    for (size_t i = 0; i < names.size(); i++) names[i] = "S" + to_string(i);
+    engine.Load(names);
+    array<uint8_t, 32> seed{};
+    VerifiableSession session;
+    RunTimed("session/begin_reveal/60", [&](uint64_t n) {
+        return Measure([&] { session.Begin(engine, seed); session.Reveal(); }, n);
+    });
+    vector<int> picked;
+    string transcript;
+    auto lesson = [&] {
+        session.Begin(engine, seed);
+        for (int i = 0; i < 40; i++)
+        {
+            DrawStatus status = engine.Draw(1, picked, session.Stream());
+            session.Record("draw", { 1 }, status, picked);
+        }
+        transcript = session.Reveal();
+    };
+    RunTimed("session/lesson/40/60", [&](uint64_t n) {
+        return Measure(lesson, n);
+    });
+    RandomEngine replay;
+    replay.Load(names);
+    size_t operations;
+    string error;
+    RunTimed("session/verify/40/60", [&](uint64_t n) {
+        return Measure([&] { VerifyTranscript(replay, transcript, operations, error); }, n);
+    }, static_cast<double>(transcript.size()));
+}
+
+// 并集视图：8 份每份 rows 人、相邻两份重叠一半的名单；建立视图只与名单数有关，单人抽取含逐份查重
+static void BenchUnion()
+{
+    vector<size_t> sizes = { 60, 10000 };
+    for (size_t rows : sizes)
+    {
+        vector<shared_ptr<const RandomEngine>> members;
+        for (size_t m = 0; m < 8; m++)
+        {
+            vector<string> names(rows);
+            for (size_t i = 0; i < rows; i++) names[i] = "S" + to_string(m * rows / 2 + i);
+            auto member = make_shared<RandomEngine>();
+            member->Load(names);
+            members.push_back(member);
+        }
+        string suffix = "/8x" + to_string(rows);
+        RunTimed("union/create" + suffix, [&](uint64_t n) {
+            return Measure([&] { UnionRoster view(members); }, n);
+        });
+        UnionRoster view(members);
+        RandomStream gen(12345);
+        vector<size_t> picked;
+        view.Draw(0, picked, gen); // 统计并集人数、分配历史（不计时）
+        RunTimed("union/draw_k1" + suffix, [&](uint64_t n) {
+            double total = 0;
+            for (uint64_t done = 0; done < n; done += 10)
+            {
+                view.ClearHistory();
+                total += Measure([&] { view.Draw(1, picked, gen); }, min<uint64_t>(10, n - done));
+            }
+            return total;
+        });
+    }
+}
+
+// 互斥约束：60 人的班级每次抽 5 人，随机的 0 或 200 对约束；每抽满一轮清空一次（计入耗时）
+static void BenchExclusions()
+{
+    for (size_t rows : { 60, 1000 })
+    {
+        for (size_t pairs : { 0, 200 })
+        {
+            string name = "exclusion/k5/" + to_string(rows) + "/pairs" + to_string(pairs);
+            if (!Selected(name)) continue;
+            RandomEngine engine;
+            vector<string> names(rows);
+            for (size_t i = 0; i < rows; i++) names[i] = "S" + to_string(i);
+            engine.Load(names);
+            RandomStream gen(12345);
+            while (engine.ExclusionCount() < pairs)
+                engine.AddExclusion(static_cast<int>(gen() % rows), static_cast<int>(gen() % rows));
+            vector<int> picked;
+            RunTimed(name, [&](uint64_t n) {
+                return Measure([&] {
+                    if (engine.Draw(5, picked, gen) != DrawStatus::Ok) engine.ClearHistory();
+                }, n);
+            });
+        }
+    }
+}
+
+// 积分：随机加分后立即刷新前 10 名的积分榜，积分分布较散（大量同分时排序树同样适用）
+static void BenchScores()
+{
+    vector<size_t> sizes = { 60, 10000 };
+    if (!options.quick) sizes.push_back(100000);
+    for (size_t rows : sizes)
+    {
+        RandomEngine engine;
+        vector<string> names(rows);
+        for (size_t i = 0; i < rows; i++) names[i] = "S" + to_string(i);
+        engine.Load(names);
+        RandomStream gen(12345);
+        for (size_t i = 0; i < rows; i++)
+            engine.AddScore(static_cast<int>(i), static_cast<int32_t>(gen() % 1000));
+        vector<int> ranked;
+        RunTimed("scores/award/" + to_string(rows), [&](uint64_t n) {
+            return Measure([&] { engine.AddScore(static_cast<int>(gen() % rows), static_cast<int32_t>(gen() % 7) - 3); }, n);
+        });
+        RunTimed("scores/award_top10/" + to_string(rows), [&](uint64_t n) {
+            return Measure([&] {
+                engine.AddScore(static_cast<int>(gen() % rows), static_cast<int32_t>(gen() % 7) - 3);
+                engine.Ranking(10, true, ranked);
+            }, n);
+        });
+    }
+}
+
+// 名单集合运算：两份 rows 人、重叠一半的名单，按规范化姓名与按学号各做一次交集、差集、并集（含载入结果名单）
+static void BenchAlgebra()
+{
+    vector<size_t> sizes = { 1000, 50000 };
+    for (size_t rows : sizes)
+    {
+        RandomEngine a, b, result;
+        vector<string> namesA(rows), namesB(rows), idsA(rows), idsB(rows);
+        for (size_t i = 0; i < rows; i++)
+        {
+            namesA[i] = "Student " + to_string(i);
+            namesB[i] = "student  " + to_string(i + rows / 2);
+            idsA[i] = to_string(i);
+            idsB[i] = to_string(i + rows / 2);
+        }
+        a.Load(namesA, {}, {}, idsA);
+        b.Load(namesB, {}, {}, idsB);
+        static const char* OP_NAMES[] = { "intersect", "difference", "union" };
+        for (RosterKey key : { RosterKey::Name, RosterKey::Id })
+        {
+            for (int op = 0; op < 3; op++)
+            {
+                string name = string("roster_algebra/") + OP_NAMES[op] + (key == RosterKey::Name ? "/name/" : "/id/") + to_string(rows);
+                RunTimed(name, [&](uint64_t n) {
+                    return Measure([&] { CombineRosters(a, b, static_cast<SetOp>(op), key, result); }, n);
+                }, 0, 200);
+            }
+        }
+    }
+}
+
+static void BenchTOTP()
+{
+    vector<uint8_t> key(20);
+    for (size_t i = 0; i < key.size(); i++) key[i] = static_cast<uint8_t>(i * 7 + 1);
+    uint8_t msg[8] = { 0, 0, 0, 0, 0, 0x3a, 0x9f, 0x51 };
+    uint8_t out[20];
+
+    RunTimed("totp/hmac_sha1/8B", [&](uint64_t n) {
+        return Measure([&] { HmacSha1(key.data(), key.size(), msg, sizeof(msg), out); msg[7] ^= out[0]; }, n);
+    }, 8);
+
+    vector<uint8_t> page(4096, 0x5a);
+    RunTimed("totp/hmac_sha1/4KiB", [&](uint64_t n) {
+        return Measure([&] { HmacSha1(key.data(), key.size(), page.data(), page.size(), out); page[0] ^= out[0]; }, n);
+    }, 4096);
+
+    uint64_t counter = 0;
+    RunTimed("totp/hotp_code", [&](uint64_t n) {
+        return Measure([&] { HotpCode(key.data(), key.size(), counter++, 6); }, n);
+    });
+
+    // 默认 Info 级别，另测关闭日志与 Debug 级别，比较日志对验证路径的影响
+    const pair<const char*, LogLevel> levels[] = {
+        { "totp/verify", LogLevel::Info },
+        { "totp/verify/log_off", LogLevel::Off },
+        { "totp/verify/log_debug", LogLevel::Debug },
+    };
+    for (const auto& level : levels)
+    {
+        if (!Selected(level.first)) continue;
+        Platform::WriteSecret(TOTP_SECRET_NAME, key);
+        Log::SetLevel(level.second);
+        RunTimed(level.first, [&](uint64_t n) {
+            return Measure([&] { VerifyTOTP(L"000000"); }, n);
+        });
+        Log::Flush();
+    }
+    Log::SetLevel(LogLevel::Info);
+}
+
+// 关闭与开启追踪时一个空 span 的开销
+static void BenchTrace()
+{
+    volatile uint64_t sink = 0;
+    for (bool on : { false, true })
+    {
+        Trace::SetEnabled(on);
+        RunTimed(string("trace/span_") + (on ? "enabled" : "disabled"), [&](uint64_t n) {
+            return Measure([&] { IC_TRACE_SPAN(TraceOp::Draw); sink = sink + 1; }, n);
+        });
+    }
+    Trace::SetEnabled(false);
+    Trace::Reset();
+}
+
+// 计数器写入（线程本地分片）与导出汇总的开销
+static void BenchMetrics()
+{
+    RunTimed("metrics/add", [&](uint64_t n) {
+        return Measure([&] { Metrics::Add(Counter::DrawCalls); }, n);
+    });
+    RunTimed("metrics/snapshot_json", [&](uint64_t n) {
+        return Measure([&] { Platform::FreeString(GetMetricsSnapshot()); }, n);
+    });
+}
+
+// ---------- 输出与比较 ----------
+
+static string HostDescription()
+{
+#ifdef _WIN32
+    return "windows";
+#else
+    utsname u;
+    uname(&u);
+    return string(u.sysname) + " " + u.release + " " + u.machine;
+#endif
+}
+
+static void WriteJson(ostream& os)
+{
+    os << "{\n  \"schema\": 1,\n  \"host\": \"" << HostDescription() << "\",\n";
+    os << "  \"min_time_s\": " << options.minTime << ",\n  \"samples\": " << options.samples << ",\n";
+    os << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult& r = results[i];
+        os << "    { \"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+            << fixed << setprecision(2)
+            << ", \"ns_per_op\": " << r.nsPerOpMedian
+            << ", \"ns_per_op_min\": " << r.nsPerOpMin
+            << ", \"ops_per_s\": " << 1e9 / r.nsPerOpMedian;
+        if (r.bytesPerOp > 0)
+            os << ", \"mb_per_s\": " << r.bytesPerOp * 1e3 / r.nsPerOpMedian;
+        os << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}\n";
+}
+
+// 只解析本程序自己输出的格式：逐行提取 name 与 ns_per_op
+static map<string, double> ReadBaseline(const string& path)
+{
+    map<string, double> baseline;
+    ifstream file(path);
+    string line;
+    while (getline(file, line))
+    {
+        size_t namePos = line.find("\"name\": \"");
+        size_t nsPos = line.find("\"ns_per_op\": ");
+        if (namePos == string::npos || nsPos == string::npos) continue;
+        namePos += 9;
+        string name = line.substr(namePos, line.find('"', namePos) - namePos);
+        baseline[name] = atof(line.c_str() + nsPos + 13);
+    }
+    return baseline;
+}
+
+static void PrintComparison(const map<string, double>& baseline)
+{
+    cerr << "\n" << left << setw(44) << "benchmark" << right << setw(14) << "baseline" << setw(14) << "current" << setw(10) << "change\n";
+    for (const BenchResult& r : results)
+    {
+        auto it = baseline.find(r.name);
+        if (it == baseline.end() || it->second <= 0) continue;
+        double change = (r.nsPerOpMedian - it->second) / it->second * 100;
+        cerr << left << setw(44) << r.name << right << fixed << setprecision(1)
+            << setw(14) << it->second << setw(14) << r.nsPerOpMedian
+            << setw(9) << showpos << change << noshowpos << "%\n";
+    }
+}
+
+static void SetupHome()
+{
+#ifdef _WIN32
+    char buffer[MAX_PATH];
+    GetTempPathA(MAX_PATH, buffer);
+    benchHome = string(buffer) + "IslandCallerBench";
+    CreateDirectoryA(benchHome.c_str(), NULL);
+    CreateDirectoryA((benchHome + "\\Profile").c_str(), NULL);
+    _putenv_s("ISLANDCALLER_HOME", benchHome.c_str());
+#else
+    char templ[] = "/tmp/ic_core_bench.XXXXXX";
+    benchHome = mkdtemp(templ);
+    setenv("ISLANDCALLER_HOME", benchHome.c_str(), 1);
+    system(("mkdir -p " + benchHome + "/Profile").c_str());
+#endif
+}
+
+static void CleanupHome()
+{
+#ifndef _WIN32
+    system(("rm -rf " + benchHome).c_str());
+#endif
+}
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) options.filter = argv[++i];
+        else if (arg == "--quick") options.quick = true;
+        else if (arg == "--min-time" && i + 1 < argc) options.minTime = atof(argv[++i]);
+        else if (arg == "--samples" && i + 1 < argc) options.samples = max(1, atoi(argv[++i]));
+        else if (arg == "--out" && i + 1 < argc) options.outPath = argv[++i];
+        else if (arg == "--compare" && i + 1 < argc) options.comparePath = argv[++i];
+        else
+        {
+            cerr << "usage: ic_core_bench [--filter s] [--quick] [--min-time sec] [--samples n] [--out file.json] [--compare baseline.json]\n";
+            return 2;
+        }
+    }
+
+    ios::sync_with_stdio(false);
+    Log::SetSink([](string_view) {}); // 丢弃 Core 的日志输出，避免 I/O 干扰计时
+    SetupHome();
+
+    BenchImport();
+    BenchDraw();
+    BenchDrawKernel();
+    BenchAnimation();
+    BenchRng();
+    BenchStratified();
+    BenchSpatial();
+    BenchClear();
+    BenchUndo();
+    BenchExclusions();
+    BenchState();
+    BenchSession();
+    BenchUnion();
+    BenchAlgebra();
+    BenchScores();
+    BenchTOTP();
+    BenchTrace();
+    BenchMetrics();
+
+    if (options.outPath.empty())
+        WriteJson(cout);
+    else
+    {
+        ofstream out(options.outPath);
+        WriteJson(out);
+    }
+    if (!options.comparePath.empty())
+        PrintComparison(ReadBaseline(options.comparePath));
+
+    CleanupHome();
+    return 0;
+}
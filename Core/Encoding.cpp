@@ -0,0 +1,115 @@
+#include "pch.h"
+#include "Encoding.h"
+using namespace std;
+
+static constexpr char32_t REPLACEMENT = 0xFFFD;
+
+// 从 utf8[pos] 开始解码一个码点，pos 前进到下一个码点；非法序列只消耗一个字节并返回 U+FFFD
+static char32_t DecodeOne(string_view utf8, size_t& pos)
+{
+    unsigned char c = static_cast<unsigned char>(utf8[pos]);
+    if (c < 0x80) { pos++; return c; }
+
+    int length;
+    char32_t cp;
+    char32_t min;
+    if ((c & 0xE0) == 0xC0) { length = 2; cp = c & 0x1F; min = 0x80; }
+    else if ((c & 0xF0) == 0xE0) { length = 3; cp = c & 0x0F; min = 0x800; }
+    else if ((c & 0xF8) == 0xF0) { length = 4; cp = c & 0x07; min = 0x10000; }
+    else { pos++; return REPLACEMENT; }
+
+    if (pos + length > utf8.size()) { pos++; return REPLACEMENT; }
+    for (int i = 1; i < length; i++)
+    {
+        unsigned char cc = static_cast<unsigned char>(utf8[pos + i]);
+        if ((cc & 0xC0) != 0x80) { pos++; return REPLACEMENT; }
+        cp = (cp << 6) | (cc & 0x3F);
+    }
+    if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) { pos++; return REPLACEMENT; }
+    pos += length;
+    return cp;
+}
+
+wstring Utf8ToWide(string_view utf8)
+{
+    wstring out;
+    out.reserve(utf8.size());
+    size_t pos = 0;
+    while (pos < utf8.size())
+    {
+        // ASCII 快速路径
+        unsigned char c = static_cast<unsigned char>(utf8[pos]);
+        if (c < 0x80) { out.push_back(static_cast<wchar_t>(c)); pos++; continue; }
+        char32_t cp = DecodeOne(utf8, pos);
+        if constexpr (sizeof(wchar_t) == 2)
+        {
+            if (cp >= 0x10000)
+            {
+                cp -= 0x10000;
+                out.push_back(static_cast<wchar_t>(0xD800 + (cp >> 10)));
+                out.push_back(static_cast<wchar_t>(0xDC00 + (cp & 0x3FF)));
+                continue;
+            }
+        }
+        out.push_back(static_cast<wchar_t>(cp));
+    }
+    return out;
+}
+
+string WideToUtf8(wstring_view wide)
+{
+    string out;
+    out.reserve(wide.size());
+    for (size_t i = 0; i < wide.size(); i++)
+    {
+        char32_t cp = static_cast<char32_t>(wide[i]);
+        if constexpr (sizeof(wchar_t) == 2)
+        {
+            if (cp >= 0xD800 && cp <= 0xDBFF && i + 1 < wide.size())
+            {
+                char32_t low = static_cast<char32_t>(wide[i + 1]);
+                if (low >= 0xDC00 && low <= 0xDFFF)
+                {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    i++;
+                }
+            }
+        }
+        if (cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) cp = REPLACEMENT;
+
+        if (cp < 0x80) out.push_back(static_cast<char>(cp));
+        else if (cp < 0x800)
+        {
+            out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+        else if (cp < 0x10000)
+        {
+            out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+        else
+        {
+            out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+    }
+    return out;
+}
+
+bool IsValidUtf8(string_view utf8)
+{
+    size_t pos = 0;
+    while (pos < utf8.size())
+    {
+        if (static_cast<unsigned char>(utf8[pos]) < 0x80) { pos++; continue; }
+        size_t start = pos;
+        char32_t cp = DecodeOne(utf8, pos);
+        // 合法编码的 U+FFFD 占 3 个字节，只消耗 1 个字节说明是替换出来的
+        if (cp == REPLACEMENT && pos - start == 1) return false;
+    }
+    return true;
+}
@@ -0,0 +1,12 @@
+// UTF-8 与 wchar_t 之间的转换（Windows 上 wchar_t 为 UTF-16，POSIX 上为 UTF-32）
+// 与 wstring_convert 不同，遇到非法序列不会抛出异常，而是替换为 U+FFFD
+
+#pragma once
+#include <string>
+#include <string_view>
+
+std::wstring Utf8ToWide(std::string_view utf8);
+std::string WideToUtf8(std::wstring_view wide);
+
+// 是否为合法的 UTF-8（拒绝过长编码、代理项与超出 U+10FFFF 的码点）
+bool IsValidUtf8(std::string_view utf8);
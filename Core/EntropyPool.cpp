@@ -0,0 +1,111 @@
+#include "pch.h"
+#include "EntropyPool.h"
+#include "Metrics.h"
+#include <condition_variable>
+#include <thread>
+using namespace std;
+
+namespace
+{
+    // 共享缓冲区：ready 从 readyUsed 起可取，spare 由后台线程填满后置 spareFull
+    // 后台线程第一次需要补充时才启动，之后一直等待；对象不析构，进程退出时线程仍可安全地停在等待中。
+    // 后台线程只访问 Pool，不写计数器（进程退出时计数器可能已析构），读取次数在交换或同步读取时由取用方计入
+    struct Pool
+    {
+        mutex lock;
+        condition_variable wake;
+        uint8_t ready[Entropy::BATCH];
+        uint8_t spare[Entropy::BATCH];
+        size_t readyUsed = Entropy::BATCH;
+        bool spareFull = false;
+        bool workerStarted = false;
+    };
+
+    Pool& SharedPool()
+    {
+        static Pool* pool = new Pool();
+        return *pool;
+    }
+
+    void RefillLoop(Pool& pool)
+    {
+        uint8_t batch[Entropy::BATCH];
+        unique_lock<mutex> guard(pool.lock);
+        for (;;)
+        {
+            pool.wake.wait(guard, [&] { return !pool.spareFull; });
+            guard.unlock();
+            bool ok = Platform::GenRandom(batch, sizeof(batch));
+            guard.lock();
+            if (!ok)
+            {
+                // 系统熵源暂时不可用：留给取用方同步读取时处理，稍后再试
+                guard.unlock();
+                this_thread::sleep_for(chrono::milliseconds(100));
+                guard.lock();
+                continue;
+            }
+            memcpy(pool.spare, batch, sizeof(batch));
+            pool.spareFull = true;
+            fill(begin(batch), end(batch), 0);
+        }
+    }
+
+    // 领取 CHUNK 字节：ready 取完时换上后台填好的 spare，后台还没填好时同步读取一批
+    bool TakeChunk(uint8_t* chunk)
+    {
+        Pool& pool = SharedPool();
+        lock_guard<mutex> guard(pool.lock);
+        if (pool.readyUsed == Entropy::BATCH)
+        {
+            Metrics::Add(Counter::EntropyRefills);
+            if (pool.spareFull)
+            {
+                memcpy(pool.ready, pool.spare, Entropy::BATCH);
+                memset(pool.spare, 0, Entropy::BATCH);
+                pool.spareFull = false;
+            }
+            else if (!Platform::GenRandom(pool.ready, Entropy::BATCH))
+                return false;
+            pool.readyUsed = 0;
+            if (!pool.workerStarted)
+            {
+                pool.workerStarted = true;
+                thread(RefillLoop, ref(pool)).detach();
+            }
+            pool.wake.notify_one();
+        }
+        uint8_t* source = pool.ready + pool.readyUsed;
+        memcpy(chunk, source, Entropy::CHUNK);
+        memset(source, 0, Entropy::CHUNK);
+        pool.readyUsed += Entropy::CHUNK;
+        return true;
+    }
+
+    struct ThreadChunk
+    {
+        uint8_t bytes[Entropy::CHUNK];
+        size_t used = Entropy::CHUNK;
+    };
+}
+
+bool Entropy::Fill(uint8_t* out, size_t size)
+{
+    thread_local ThreadChunk chunk;
+    while (size > 0)
+    {
+        if (chunk.used == CHUNK)
+        {
+            if (!TakeChunk(chunk.bytes))
+                return false;
+            chunk.used = 0;
+        }
+        size_t n = min(size, CHUNK - chunk.used);
+        memcpy(out, chunk.bytes + chunk.used, n);
+        memset(chunk.bytes + chunk.used, 0, n);
+        chunk.used += n;
+        out += n;
+        size -= n;
+    }
+    return true;
+}
@@ -0,0 +1,19 @@
+// 系统熵池：Core 中所有需要系统随机数的地方（随机数主流的种子、安全流的密钥、TOTP 密钥、Windows Hello 的 Challenge）
+// 都从这里取，不再各自调用 random_device 或 BCryptGenRandom。
+//
+// 系统随机数（Platform::GenRandom）按 BATCH 字节整批读取，放在共享的两块缓冲区中：一块供取用，另一块由后台线程预先填满，
+// 取完时直接交换，调用方不必等待系统调用。每个线程再从共享缓冲区一次领取 CHUNK 字节放在线程本地，
+// 线程内的取用不加锁，只有领取时短暂加锁。已交出的字节立即从缓冲区中清零。
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace Entropy
+{
+    constexpr size_t BATCH = 4096;
+    constexpr size_t CHUNK = 256;
+
+    // 用系统随机数填充 size 字节；系统熵源不可用时返回 false（out 内容未定义）
+    bool Fill(uint8_t* out, size_t size);
+}
@@ -0,0 +1,56 @@
+// Core 导出函数声明，供测试、基准测试与命令行工具链接 ic_core 时使用
+// 与 IslandCaller.PluginForClassIsland/Models/Core.cs 中的 DllImport 保持一致
+
+#pragma once
+#include "pch.h"
+
+EXPORT_DLL int RandomImport(const wchar_t* filenameW);
+EXPORT_DLL int RandomImportGrouped(const wchar_t* filenameW, const wchar_t* groupColumnW);
+EXPORT_DLL int RandomImportColumns(const wchar_t* filenameW, const wchar_t* groupColumnW,
+    const wchar_t* rowColumnW, const wchar_t* columnColumnW);
+EXPORT_DLL int RandomImportFromPath(const wchar_t* pathW);
+EXPORT_DLL void ClearHistory();
+EXPORT_DLL void SetCooldown(const int picks);
+EXPORT_DLL void SetRandomMode(const int mode);
+EXPORT_DLL int AddExclusion(const wchar_t* nameAW, const wchar_t* nameBW);
+EXPORT_DLL void ClearExclusions();
+EXPORT_DLL BSTR SimpleRandom(const int number);
+EXPORT_DLL int AnimatedRandom(const int number, const int frames, const int durationMs, int* slots, int* timesMs, BSTR* names);
+EXPORT_DLL BSTR StratifiedRandom(const int mode, const int number);
+EXPORT_DLL BSTR SpatialRandom(const int mode, const int number);
+EXPORT_DLL BSTR RecentlyDrawn(const int rounds);
+EXPORT_DLL BSTR UndoDraw();
+EXPORT_DLL BSTR RedoDraw();
+EXPORT_DLL int SaveState(uint8_t* buffer, const int capacity);
+EXPORT_DLL int LoadState(const uint8_t* data, const int length);
+EXPORT_DLL int AwardScore(const wchar_t* nameW, const int points);
+EXPORT_DLL BSTR ScoreBoard(const int count);
+EXPORT_DLL void ClearScores();
+EXPORT_DLL BSTR BeginVerifiableSession();
+EXPORT_DLL BSTR EndVerifiableSession();
+
+EXPORT_DLL int RosterLoad(const wchar_t* filenameW);
+EXPORT_DLL void RosterRelease(const int handle);
+EXPORT_DLL int RosterUnion(const int* handles, const int count);
+EXPORT_DLL int RosterCombine(const int a, const int b, const int op, const int key);
+EXPORT_DLL int RosterActivate(const int handle);
+EXPORT_DLL int RosterSize(const int handle);
+EXPORT_DLL BSTR RosterDraw(const int handle, const int number);
+EXPORT_DLL void RosterClearHistory(const int handle);
+EXPORT_DLL int RosterSetRandomMode(const int handle, const int mode);
+
+EXPORT_DLL BSTR CreateTOTPUrl();
+EXPORT_DLL bool VerifyTOTP(const wchar_t* user_code);
+
+EXPORT_DLL void SetTracingEnabled(bool enabled);
+EXPORT_DLL void ResetTraceStats();
+EXPORT_DLL BSTR GetTraceSnapshot();
+
+EXPORT_DLL void SetLogLevel(int level);
+EXPORT_DLL BSTR GetMetricsSnapshot();
+
+EXPORT_DLL int StartIpcServer(const wchar_t* endpoint);
+EXPORT_DLL void StopIpcServer();
+
+EXPORT_DLL bool CreateHelloPasskey();
+EXPORT_DLL bool VerifyHelloPasskey();
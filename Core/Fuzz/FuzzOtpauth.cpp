@@ -0,0 +1,30 @@
+// 模糊测试：Base32 编解码、URL 百分号编解码与 otpauth URL 解析
+// 不变量：解码成功的 Base32 重新编码后可再次解码为相同字节；任意字节串 URL 编码后可原样解码
+
+#include "pch.h"
+#include "TOTP.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    std::string_view text(reinterpret_cast<const char*>(data), size);
+
+    OtpauthUrl url;
+    if (ParseOtpauthUrl(text, url) && (url.secret.empty() || url.digits < 6 || url.digits > 8))
+        abort();
+
+    std::vector<uint8_t> decoded, again;
+    if (Base32Decode(text, decoded))
+    {
+        if (!Base32Decode(Base32Encode(decoded), again) || again != decoded)
+            abort();
+    }
+
+    std::vector<uint8_t> bytes(data, data + size);
+    if (!Base32Decode(Base32Encode(bytes), decoded) || decoded != bytes)
+        abort();
+
+    std::string raw(text), unescaped;
+    if (!UrlDecode(UrlEncode(raw), unescaped) || unescaped != raw)
+        abort();
+    return 0;
+}
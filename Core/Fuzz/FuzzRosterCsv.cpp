@@ -0,0 +1,32 @@
+// 模糊测试：名单 CSV 解析与导入后的抽取
+// 不变量：解析出的姓名非空且没有首尾空白；载入引擎后可以连续抽完一整轮且不重复
+
+#include "pch.h"
+#include "RandomEngine.h"
+#include "RosterParser.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    std::string_view text(reinterpret_cast<const char*>(data), size);
+    std::vector<std::string> names;
+    ParseRoster(text, names);
+    for (const std::string& name : names)
+    {
+        if (name.empty() || TrimField(name).size() != name.size())
+            abort();
+    }
+
+    RandomEngine engine;
+    if (engine.Load(names) != 0)
+        return 0;
+    RandomStream gen(size);
+    std::vector<int> picked;
+    std::vector<char> seen(engine.Size(), 0);
+    for (size_t drawn = 0; drawn < engine.Size(); drawn++)
+    {
+        if (engine.Draw(1, picked, gen) != DrawStatus::Ok || seen[picked[0]])
+            abort();
+        seen[picked[0]] = 1;
+    }
+    return 0;
+}
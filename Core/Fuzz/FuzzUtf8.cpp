@@ -0,0 +1,23 @@
+// 模糊测试：UTF-8 与 wchar_t 之间的转换
+// 不变量：任意输入都能转换且输出总是合法 UTF-8；合法输入往返转换后保持不变
+
+#include "pch.h"
+#include "Encoding.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    std::string_view text(reinterpret_cast<const char*>(data), size);
+    std::string roundTrip = WideToUtf8(Utf8ToWide(text));
+    if (!IsValidUtf8(roundTrip))
+        abort();
+    if (IsValidUtf8(text) && roundTrip != text)
+        abort();
+
+    // 把输入直接当作 wchar_t 序列（可能含孤立代理项或越界码点）
+    std::wstring wide(size / sizeof(wchar_t), L'\0');
+    if (!wide.empty())
+        memcpy(wide.data(), data, wide.size() * sizeof(wchar_t));
+    if (!IsValidUtf8(WideToUtf8(wide)))
+        abort();
+    return 0;
+}
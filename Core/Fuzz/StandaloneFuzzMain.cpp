@@ -0,0 +1,53 @@
+// 不使用 libFuzzer 时（GCC、MSVC 或 AFL）的入口：
+//   无参数时从标准输入读取一个样本（AFL 的默认方式）
+//   有参数时逐个执行给出的文件，目录则执行其中的所有文件（用于回放种子语料）
+// 以 '-' 开头的参数按 libFuzzer 选项忽略，便于与 libFuzzer 构建共用同一条测试命令
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+static void RunFile(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    LLVMFuzzerTestOneInput(data.data(), data.size());
+}
+
+int main(int argc, char** argv)
+{
+    size_t runs = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (argv[i][0] == '-') continue;
+        std::filesystem::path path(argv[i]);
+        if (std::filesystem::is_directory(path))
+        {
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(path))
+            {
+                if (!entry.is_regular_file()) continue;
+                RunFile(entry.path());
+                runs++;
+            }
+        }
+        else
+        {
+            RunFile(path);
+            runs++;
+        }
+    }
+    if (runs == 0)
+    {
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(data.data(), data.size());
+        runs++;
+    }
+    std::cerr << "Executed " << runs << " inputs\n";
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include "pch.h"
+#include "IpcServer.h"
+#include "RandomEngine.h"
+#include "Metrics.h"
+#include "Encoding.h"
+#include "Exports.h"
+using namespace std;
+
+void Ipc::EncodeRequest(Op op, uint16_t arg, uint8_t out[REQUEST_SIZE])
+{
+    out[0] = static_cast<uint8_t>(op);
+    out[1] = 0;
+    out[2] = static_cast<uint8_t>(arg);
+    out[3] = static_cast<uint8_t>(arg >> 8);
+}
+
+static string Response(Ipc::Status status, uint8_t op, const string& payload)
+{
+    uint32_t length = static_cast<uint32_t>(payload.size());
+    string out(Ipc::RESPONSE_HEADER_SIZE, '\0');
+    out[0] = static_cast<char>(status);
+    out[1] = static_cast<char>(op);
+    for (int i = 0; i < 4; i++)
+        out[4 + i] = static_cast<char>(length >> (8 * i));
+    return out + payload;
+}
+
+string Ipc::HandleRequest(const uint8_t request[REQUEST_SIZE])
+{
+    uint8_t op = request[0];
+    uint16_t arg = static_cast<uint16_t>(request[2] | (request[3] << 8));
+    switch (static_cast<Op>(op))
+    {
+    case Op::Ping:
+        return Response(Status::Ok, op, "");
+    case Op::Draw:
+    {
+        string names;
+        DrawStatus status = DrawNames(arg, names);
+        if (status != DrawStatus::Ok)
+            return Response(Status::DrawFailed, op, DrawStatusMessage(status));
+        return Response(Status::Ok, op, names);
+    }
+    case Op::Clear:
+        ClearHistory();
+        return Response(Status::Ok, op, "");
+    case Op::Stats:
+        return Response(Status::Ok, op, Metrics::SnapshotJson());
+    default:
+        return Response(Status::BadRequest, op, "");
+    }
+}
+
+void Ipc::DecodeResponseHeader(const uint8_t header[RESPONSE_HEADER_SIZE], Status& status, uint32_t& length)
+{
+    status = static_cast<Status>(header[0]);
+    length = 0;
+    for (int i = 0; i < 4; i++)
+        length |= static_cast<uint32_t>(header[4 + i]) << (8 * i);
+}
+
+bool Ipc::Client::Call(Op op, uint16_t arg, Status& status, string& payload)
+{
+    uint8_t request[REQUEST_SIZE];
+    EncodeRequest(op, arg, request);
+    uint8_t header[RESPONSE_HEADER_SIZE];
+    if (!WriteAll(request, sizeof(request)) || !ReadAll(header, sizeof(header)))
+        return false;
+    uint32_t length;
+    DecodeResponseHeader(header, status, length);
+    if (length > MAX_PAYLOAD)
+        return false;
+    payload.resize(length);
+    return length == 0 || ReadAll(payload.data(), length);
+}
+
+// endpoint 为空时使用默认端点，成功返回 0
+EXPORT_DLL int StartIpcServer(const wchar_t* endpoint)
+{
+    string path = endpoint && *endpoint ? WideToUtf8(endpoint) : Platform::GetIpcEndpoint();
+    return Ipc::StartServer(path) ? 0 : -1;
+}
+
+EXPORT_DLL void StopIpcServer()
+{
+    Ipc::StopServer();
+}
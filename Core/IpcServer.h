@@ -0,0 +1,69 @@
+// 本地 IPC 服务：桌面快捷方式与命令行工具可以直接连到已加载的 Core 抽取、清空历史或读取计数，
+// 不再经过 ClassIsland 的 URI 导航逐次创建提醒窗口。
+// 端点为 Windows 命名管道或 Unix 域套接字（见 Platform::GetIpcEndpoint），
+// 服务线程用一个事件循环（重叠 I/O / poll）处理所有连接，同一连接上的请求可以流水线发送。
+//
+// 协议（小端）：
+//   请求 4 字节：op(1) | 保留(1) | arg(2)
+//   应答 8 字节头 + 负载：status(1) | op(1) | 保留(2) | 负载长度(4)，负载为 UTF-8 文本
+//   Ping  ：负载为空
+//   Draw  ：arg 为人数，负载为以两个空格分隔的姓名；失败时 status 为 DrawFailed，负载为提示文本
+//   Clear ：清空已抽取历史，负载为空
+//   Stats ：负载为 GetMetricsSnapshot 的 JSON
+
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace Ipc
+{
+    enum class Op : uint8_t
+    {
+        Ping,
+        Draw,
+        Clear,
+        Stats,
+        Count
+    };
+
+    enum class Status : uint8_t
+    {
+        Ok,
+        DrawFailed,
+        BadRequest,
+    };
+
+    constexpr size_t REQUEST_SIZE = 4;
+    constexpr size_t RESPONSE_HEADER_SIZE = 8;
+    constexpr uint32_t MAX_PAYLOAD = 1 << 24;
+
+    void EncodeRequest(Op op, uint16_t arg, uint8_t out[REQUEST_SIZE]);
+    // 处理一条完整的请求，返回完整的应答（头 + 负载）
+    std::string HandleRequest(const uint8_t request[REQUEST_SIZE]);
+    void DecodeResponseHeader(const uint8_t header[RESPONSE_HEADER_SIZE], Status& status, uint32_t& length);
+
+    // 服务端（IpcServerWin.cpp / IpcServerPosix.cpp）：在后台线程中运行事件循环，同一时间只有一个实例
+    bool StartServer(const std::string& endpoint);
+    void StopServer();
+
+    // 阻塞式客户端，供命令行工具、测试与基准测试使用
+    class Client
+    {
+    public:
+        Client() = default;
+        ~Client() { Close(); }
+        Client(const Client&) = delete;
+        Client& operator=(const Client&) = delete;
+
+        bool Connect(const std::string& endpoint);
+        // 发送一条请求并等待应答，连接出错时返回 false
+        bool Call(Op op, uint16_t arg, Status& status, std::string& payload);
+        void Close();
+
+    private:
+        bool WriteAll(const void* data, size_t length);
+        bool ReadAll(void* data, size_t length);
+
+        intptr_t handle = -1; // 套接字描述符或管道句柄
+    };
+}
@@ -0,0 +1,288 @@
+// 本地 IPC 服务的 POSIX 实现：Unix 域套接字 + poll 事件循环
+
+#include "pch.h"
+#include "IpcServer.h"
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+using namespace std;
+
+#ifdef MSG_NOSIGNAL
+static constexpr int SEND_FLAGS = MSG_NOSIGNAL; // 对端已关闭时返回 EPIPE 而不是触发 SIGPIPE
+#else
+static constexpr int SEND_FLAGS = 0;
+#endif
+
+// 待写出的应答达到 OUTPUT_LIMIT 时不再读取该连接的请求，请求积压在套接字缓冲区中，由内核对客户端施加背压；
+// 一次读入的请求仍可能使应答超出，超过 OUTPUT_DROP 的连接（只发不收的客户端）直接断开
+static constexpr size_t OUTPUT_LIMIT = 256 * 1024;
+static constexpr size_t OUTPUT_DROP = 16 * OUTPUT_LIMIT;
+
+struct Connection
+{
+    int fd = -1;
+    string input;           // 尚未凑满一条请求的字节
+    string output;          // 尚未写出的应答
+    size_t written = 0;
+};
+
+static mutex serverMutex;   // 保护启动与停止
+static thread serverThread;
+static int wakePipe[2] = { -1, -1 };
+static string socketPath;
+
+static void SetNonBlocking(int fd)
+{
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+static bool FillAddress(const string& path, sockaddr_un& address)
+{
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path))
+        return false;
+    memcpy(address.sun_path, path.data(), path.size());
+    return true;
+}
+
+// 尽量写出待发送的应答，返回 false 表示连接已失效
+static bool Flush(Connection& c)
+{
+    while (c.written < c.output.size())
+    {
+        ssize_t n = send(c.fd, c.output.data() + c.written, c.output.size() - c.written, SEND_FLAGS);
+        if (n < 0)
+        {
+            // 已写出的部分积累较多时丢掉，边收边写的连接上 output 不会一直增长
+            if (c.written >= OUTPUT_LIMIT)
+            {
+                c.output.erase(0, c.written);
+                c.written = 0;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        c.written += static_cast<size_t>(n);
+    }
+    c.output.clear();
+    c.written = 0;
+    return true;
+}
+
+// 读入一块数据并处理其中完整的请求，返回 false 表示连接已关闭或应答积压过多
+// 每次只读一块，input 不超过一块加上不足一条请求的字节
+static bool Receive(Connection& c)
+{
+    char buffer[4096];
+    ssize_t n;
+    do
+    {
+        n = recv(c.fd, buffer, sizeof(buffer), 0);
+    } while (n < 0 && errno == EINTR);
+    if (n == 0) return false;
+    if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK;
+    c.input.append(buffer, static_cast<size_t>(n));
+    size_t used = 0;
+    for (; c.input.size() - used >= Ipc::REQUEST_SIZE; used += Ipc::REQUEST_SIZE)
+        c.output += Ipc::HandleRequest(reinterpret_cast<const uint8_t*>(c.input.data() + used));
+    c.input.erase(0, used);
+    return c.output.size() - c.written <= OUTPUT_DROP;
+}
+
+static void ServeLoop(int listener, int wake)
+{
+    vector<Connection> connections;
+    vector<pollfd> fds;
+    while (true)
+    {
+        fds.clear();
+        fds.push_back({ wake, POLLIN, 0 });
+        fds.push_back({ listener, POLLIN, 0 });
+        // 有应答没写完时等待可写；积压的应答达到上限后只等待可写，写出一部分之前不再读取新请求
+        for (const Connection& c : connections)
+        {
+            size_t pending = c.output.size() - c.written;
+            short events = static_cast<short>((pending < OUTPUT_LIMIT ? POLLIN : 0) | (pending > 0 ? POLLOUT : 0));
+            fds.push_back({ c.fd, events, 0 });
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0)
+        {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[0].revents)
+            break;
+
+        for (size_t i = 0; i + 2 < fds.size(); i++)
+        {
+            Connection& c = connections[i];
+            short events = fds[i + 2].revents;
+            if (!events) continue;
+            bool alive = true;
+            if (events & (POLLIN | POLLHUP | POLLERR))
+                alive = Receive(c);
+            if (alive)
+                alive = Flush(c);
+            if (!alive || (events & POLLNVAL))
+            {
+                close(c.fd);
+                c.fd = -1;
+            }
+        }
+        connections.erase(remove_if(connections.begin(), connections.end(),
+            [](const Connection& c) { return c.fd < 0; }), connections.end());
+
+        if (fds[1].revents & POLLIN)
+        {
+            int fd;
+            while ((fd = accept(listener, nullptr, nullptr)) >= 0)
+            {
+                SetNonBlocking(fd);
+                Connection c;
+                c.fd = fd;
+                connections.push_back(move(c));
+            }
+        }
+    }
+    for (const Connection& c : connections)
+        close(c.fd);
+    close(listener);
+}
+
+bool Ipc::StartServer(const string& endpoint)
+{
+    lock_guard<mutex> lock(serverMutex);
+    if (serverThread.joinable())
+        return false;
+
+    sockaddr_un address;
+    if (!FillAddress(endpoint, address))
+        return false;
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+        return false;
+    // 端点上已有服务在监听时不抢占；只是上次未清理的套接字文件则删除后重新绑定
+    if (connect(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0)
+    {
+        close(listener);
+        return false;
+    }
+    close(listener);
+    unlink(endpoint.c_str());
+
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+        return false;
+    // 套接字文件在 bind 时按进程的 umask 创建，而 umask 是进程级的，改它会影响其他线程同时创建的文件：
+    // 改为在同目录下新建的私有目录（0700）中绑定、改成 0600，再改名到端点，其他用户始终无法在改权限之前连接
+    string privateDirectory = endpoint + ".XXXXXX";
+    if (!mkdtemp(privateDirectory.data()))
+    {
+        close(listener);
+        return false;
+    }
+    string temporary = privateDirectory + "/s";
+    sockaddr_un temporaryAddress;
+    bool bound = FillAddress(temporary, temporaryAddress) &&
+        bind(listener, reinterpret_cast<sockaddr*>(&temporaryAddress), sizeof(temporaryAddress)) == 0 &&
+        chmod(temporary.c_str(), 0600) == 0 &&
+        rename(temporary.c_str(), endpoint.c_str()) == 0;
+    unlink(temporary.c_str()); // 改名成功后已不存在
+    rmdir(privateDirectory.c_str());
+    if (!bound ||
+        listen(listener, SOMAXCONN) != 0 ||
+        pipe(wakePipe) != 0)
+    {
+        close(listener);
+        unlink(endpoint.c_str());
+        return false;
+    }
+    SetNonBlocking(listener);
+    socketPath = endpoint;
+    serverThread = thread(ServeLoop, listener, wakePipe[0]);
+    return true;
+}
+
+void Ipc::StopServer()
+{
+    lock_guard<mutex> lock(serverMutex);
+    if (!serverThread.joinable())
+        return;
+    char signal = 1;
+    (void)!write(wakePipe[1], &signal, 1);
+    serverThread.join();
+    close(wakePipe[0]);
+    close(wakePipe[1]);
+    wakePipe[0] = wakePipe[1] = -1;
+    unlink(socketPath.c_str());
+}
+
+// 进程退出时停止服务线程，避免销毁仍可 join 的 std::thread
+static struct ServerGuard
+{
+    ~ServerGuard() { Ipc::StopServer(); }
+} serverGuard;
+
+bool Ipc::Client::Connect(const string& endpoint)
+{
+    Close();
+    sockaddr_un address;
+    if (!FillAddress(endpoint, address))
+        return false;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return false;
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    handle = fd;
+    return true;
+}
+
+bool Ipc::Client::WriteAll(const void* data, size_t length)
+{
+    const char* p = static_cast<const char*>(data);
+    while (length > 0)
+    {
+        ssize_t n = send(static_cast<int>(handle), p, length, SEND_FLAGS);
+        if (n < 0)
+        {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool Ipc::Client::ReadAll(void* data, size_t length)
+{
+    char* p = static_cast<char*>(data);
+    while (length > 0)
+    {
+        ssize_t n = recv(static_cast<int>(handle), p, length, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void Ipc::Client::Close()
+{
+    if (handle >= 0)
+        close(static_cast<int>(handle));
+    handle = -1;
+}
+#endif
@@ -0,0 +1,261 @@
+// 本地 IPC 服务的 Windows 实现：命名管道 + 重叠 I/O，
+// 一个线程在 WaitForMultipleObjects 上同时等待所有管道实例，每个实例按“连接 → 读 → 写 → 读 ...”的状态机推进
+
+#include "pch.h"
+#include "IpcServer.h"
+#include "Encoding.h"
+#ifdef _WIN32
+#include <sddl.h>
+#include <memory>
+#include <thread>
+using namespace std;
+
+static constexpr DWORD INSTANCES = 16;      // 同时服务的连接数，加上停止事件不超过 MAXIMUM_WAIT_OBJECTS
+static constexpr DWORD BUFFER_SIZE = 4096;
+
+enum class PipeState { Connecting, Reading, Writing };
+
+struct PipeInstance
+{
+    HANDLE pipe = INVALID_HANDLE_VALUE;
+    OVERLAPPED overlapped = {};
+    PipeState state = PipeState::Connecting;
+    bool pending = false;   // 是否有尚未完成的重叠操作
+    uint8_t buffer[BUFFER_SIZE];
+    string input;           // 尚未凑满一条请求的字节
+    string output;          // 尚未写出的应答
+};
+
+static mutex serverMutex;   // 保护启动与停止
+static thread serverThread;
+static HANDLE stopEvent = NULL;
+
+// 等待下一个客户端；客户端在此之前已经连上时手动置位事件，由事件循环直接进入读取
+static void Listen(PipeInstance& p)
+{
+    p.state = PipeState::Connecting;
+    p.input.clear();
+    p.output.clear();
+    p.pending = false;
+    ConnectNamedPipe(p.pipe, &p.overlapped);
+    DWORD error = GetLastError();
+    if (error == ERROR_IO_PENDING)
+        p.pending = true;
+    else if (error == ERROR_PIPE_CONNECTED)
+        SetEvent(p.overlapped.hEvent);
+}
+
+static void Reconnect(PipeInstance& p)
+{
+    DisconnectNamedPipe(p.pipe);
+    Listen(p);
+}
+
+// 重叠句柄上的读写即使同步完成也会置位事件，因此统一在事件循环里取结果
+static void StartRead(PipeInstance& p)
+{
+    p.state = PipeState::Reading;
+    if (!ReadFile(p.pipe, p.buffer, BUFFER_SIZE, NULL, &p.overlapped) && GetLastError() != ERROR_IO_PENDING)
+        return Reconnect(p);
+    p.pending = true;
+}
+
+static void StartWrite(PipeInstance& p)
+{
+    p.state = PipeState::Writing;
+    if (!WriteFile(p.pipe, p.output.data(), static_cast<DWORD>(p.output.size()), NULL, &p.overlapped) && GetLastError() != ERROR_IO_PENDING)
+        return Reconnect(p);
+    p.pending = true;
+}
+
+static void Advance(PipeInstance& p, DWORD bytes)
+{
+    switch (p.state)
+    {
+    case PipeState::Connecting:
+        StartRead(p);
+        break;
+    case PipeState::Reading:
+    {
+        p.input.append(reinterpret_cast<const char*>(p.buffer), bytes);
+        size_t used = 0;
+        for (; p.input.size() - used >= Ipc::REQUEST_SIZE; used += Ipc::REQUEST_SIZE)
+            p.output += Ipc::HandleRequest(reinterpret_cast<const uint8_t*>(p.input.data() + used));
+        p.input.erase(0, used);
+        if (p.output.empty()) StartRead(p);
+        else StartWrite(p);
+        break;
+    }
+    case PipeState::Writing:
+        p.output.erase(0, bytes);
+        if (p.output.empty()) StartRead(p);
+        else StartWrite(p);
+        break;
+    }
+}
+
+static void ServeLoop(vector<unique_ptr<PipeInstance>> pipes, HANDLE stop)
+{
+    vector<HANDLE> events = { stop };
+    for (auto& p : pipes)
+        events.push_back(p->overlapped.hEvent);
+
+    while (true)
+    {
+        DWORD index = WaitForMultipleObjects(static_cast<DWORD>(events.size()), events.data(), FALSE, INFINITE);
+        if (index == WAIT_OBJECT_0 || index >= WAIT_OBJECT_0 + events.size())
+            break;
+        PipeInstance& p = *pipes[index - WAIT_OBJECT_0 - 1];
+        DWORD bytes = 0;
+        if (p.pending)
+        {
+            p.pending = false;
+            if (!GetOverlappedResult(p.pipe, &p.overlapped, &bytes, FALSE))
+            {
+                Reconnect(p);
+                continue;
+            }
+        }
+        Advance(p, bytes);
+    }
+
+    for (auto& p : pipes)
+    {
+        if (p->pending)
+        {
+            DWORD bytes;
+            CancelIoEx(p->pipe, &p->overlapped);
+            GetOverlappedResult(p->pipe, &p->overlapped, &bytes, TRUE); // 等待取消完成后才能释放 OVERLAPPED
+        }
+        DisconnectNamedPipe(p->pipe);
+        CloseHandle(p->pipe);
+        CloseHandle(p->overlapped.hEvent);
+    }
+}
+
+bool Ipc::StartServer(const string& endpoint)
+{
+    lock_guard<mutex> lock(serverMutex);
+    if (serverThread.joinable())
+        return false;
+
+    // 只允许当前用户连接：受保护的 DACL 只有当前用户一项，与 POSIX 下权限 0600 的套接字文件对应
+    wstring sid = Platform::CurrentUserSid();
+    PSECURITY_DESCRIPTOR descriptor = NULL;
+    if (sid.empty() ||
+        !ConvertStringSecurityDescriptorToSecurityDescriptorW((L"D:P(A;;GA;;;" + sid + L")").c_str(), SDDL_REVISION_1, &descriptor, NULL))
+        return false;
+    SECURITY_ATTRIBUTES attributes = { sizeof(attributes), descriptor, FALSE };
+
+    wstring name = Utf8ToWide(endpoint);
+    vector<unique_ptr<PipeInstance>> pipes;
+    for (DWORD i = 0; i < INSTANCES; i++)
+    {
+        auto p = make_unique<PipeInstance>();
+        // 第一个实例带 FILE_FLAG_FIRST_PIPE_INSTANCE：端点上已有服务时启动失败而不是混入对方的实例
+        DWORD openMode = PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | (i == 0 ? FILE_FLAG_FIRST_PIPE_INSTANCE : 0);
+        p->pipe = CreateNamedPipeW(name.c_str(), openMode,
+            PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+            INSTANCES, BUFFER_SIZE, BUFFER_SIZE, 0, &attributes);
+        p->overlapped.hEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+        if (p->pipe == INVALID_HANDLE_VALUE || !p->overlapped.hEvent)
+        {
+            if (p->pipe != INVALID_HANDLE_VALUE) CloseHandle(p->pipe);
+            if (p->overlapped.hEvent) CloseHandle(p->overlapped.hEvent);
+            for (auto& q : pipes)
+            {
+                CloseHandle(q->pipe);
+                CloseHandle(q->overlapped.hEvent);
+            }
+            LocalFree(descriptor);
+            return false;
+        }
+        pipes.push_back(move(p));
+    }
+    LocalFree(descriptor);
+    for (auto& p : pipes)
+        Listen(*p);
+
+    stopEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    serverThread = thread(ServeLoop, move(pipes), stopEvent);
+    return true;
+}
+
+void Ipc::StopServer()
+{
+    lock_guard<mutex> lock(serverMutex);
+    if (!serverThread.joinable())
+        return;
+    SetEvent(stopEvent);
+    serverThread.join();
+    CloseHandle(stopEvent);
+    stopEvent = NULL;
+}
+
+// DLL 卸载时持有加载器锁，join 会与线程退出互相等待，只能通知停止后分离
+// （Log.cpp 的后台线程不同：Core 在进程退出前不会卸载，它在析构时已被系统终止，可以直接 join）
+static struct ServerGuard
+{
+    ~ServerGuard()
+    {
+        lock_guard<mutex> lock(serverMutex);
+        if (!serverThread.joinable())
+            return;
+        SetEvent(stopEvent);
+        serverThread.detach();
+    }
+} serverGuard;
+
+bool Ipc::Client::Connect(const string& endpoint)
+{
+    Close();
+    wstring name = Utf8ToWide(endpoint);
+    while (true)
+    {
+        HANDLE pipe = CreateFileW(name.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+        if (pipe != INVALID_HANDLE_VALUE)
+        {
+            handle = reinterpret_cast<intptr_t>(pipe);
+            return true;
+        }
+        // 所有实例都在服务其他连接时等待空闲实例
+        if (GetLastError() != ERROR_PIPE_BUSY || !WaitNamedPipeW(name.c_str(), 2000))
+            return false;
+    }
+}
+
+bool Ipc::Client::WriteAll(const void* data, size_t length)
+{
+    const char* p = static_cast<const char*>(data);
+    while (length > 0)
+    {
+        DWORD written = 0;
+        if (!WriteFile(reinterpret_cast<HANDLE>(handle), p, static_cast<DWORD>(length), &written, NULL))
+            return false;
+        p += written;
+        length -= written;
+    }
+    return true;
+}
+
+bool Ipc::Client::ReadAll(void* data, size_t length)
+{
+    char* p = static_cast<char*>(data);
+    while (length > 0)
+    {
+        DWORD read = 0;
+        if (!ReadFile(reinterpret_cast<HANDLE>(handle), p, static_cast<DWORD>(length), &read, NULL) || read == 0)
+            return false;
+        p += read;
+        length -= read;
+    }
+    return true;
+}
+
+void Ipc::Client::Close()
+{
+    if (handle != -1)
+        CloseHandle(reinterpret_cast<HANDLE>(handle));
+    handle = -1;
+}
+#endif
@@ -0,0 +1,297 @@
+#include "pch.h"
+#include "Log.h"
+#include <condition_variable>
+#include <thread>
+using namespace std;
+
+/*
+ * 环形缓冲区采用 Vyukov 的有界队列：每个槽位带一个序号，
+ * 生产者用一次 CAS 抢占写入位置，写完后以 release 发布序号；唯一的消费者按序号判断槽位是否就绪。
+ * 生产者之间只在 enqueuePos 上竞争，与消费者不共享缓存行。
+ *
+ * 后台线程排空后没有新记录就无限期等待，不定时醒来：等待前置 idle，生产者发布记录后发现 idle 才加锁唤醒，
+ * 因此消费者忙碌时写入方不碰互斥量，空闲时每批记录最多唤醒一次。
+ */
+
+struct EventInfo
+{
+    const char* label;   // 输出中的状态字段，沿用原先控制台输出的写法
+    const char* format;  // {} 输出十进制，{x} 输出十六进制
+};
+
+static const EventInfo EVENTS[] = {
+    { "Info",    "Start create TOTP secret and url" },
+    { "Error",   "WriteSecret failed: {}" },
+    { "Success", "TOTP secret and url created successfully" },
+    { "Debug",   "TOTP URL issued, secret {} ({} bytes)" },
+    { "Info",    "Start verify TOTP code, user provided code {} ({} characters)" },
+    { "Error",   "ReadSecret failed: {}" },
+    { "Info",    "Generated code for counter {}: {}" },
+    { "Success", "TOTP code verified successfully" },
+    { "Failed",  "TOTP code wrong" },
+    { "Error",   "[CreatePasskey] Windows Hello Disable" },
+    { "Error",   "[CreatePasskey] Failed, HRESULT=0x{x}" },
+    { "Error",   "[CreatePasskey] Reg Writing Failed" },
+    { "Success", "[CreatePasskey] CredentialId Written" },
+    { "Info",    "Draw undone: {} students returned, {} more undoable" },
+    { "Info",    "Draw redone: {} students drawn again, {} more redoable" },
+    { "Info",    "Score awarded: student {} got {} points, total {}" },
+};
+static_assert(sizeof(EVENTS) / sizeof(EVENTS[0]) == static_cast<size_t>(LogEvent::Count));
+
+static constexpr size_t CAPACITY = 1024; // 必须为 2 的幂
+static constexpr int MAX_ARGS = 6;
+
+struct alignas(64) LogCell
+{
+    atomic<uint64_t> sequence;
+    LogLevel level;
+    uint8_t argc;
+    uint8_t redactedMask;
+    LogEvent event;
+    int64_t args[MAX_ARGS];
+};
+static_assert(sizeof(LogCell) == 64);
+
+class LogRing
+{
+public:
+    LogRing()
+    {
+        for (size_t i = 0; i < CAPACITY; i++)
+            cells[i].sequence.store(i, memory_order_relaxed);
+    }
+
+    ~LogRing()
+    {
+        if (!started.load()) return;
+        // Windows 上 Core 由 DllImport 加载，进程退出前不会卸载：静态析构时后台线程已被系统终止，
+        // 可能正持有 wakeMutex 或 consumerMutex（在 fwrite 中途），此时不再通知，join 立即返回
+#ifdef _WIN32
+        bool exited = WaitForSingleObject(drainThread.native_handle(), 0) == WAIT_OBJECT_0;
+#else
+        bool exited = false;
+#endif
+        if (!exited)
+        {
+            {
+                lock_guard<mutex> lock(wakeMutex);
+                stopping = true;
+            }
+            wake.notify_one();
+        }
+        drainThread.join();
+        // 剩余记录在此同步输出；consumerMutex 被已终止的线程占着时放弃，不让退出挂起
+        unique_lock<mutex> lock(consumerMutex, try_to_lock);
+        if (lock.owns_lock())
+            DrainLocked();
+    }
+
+    void Push(LogLevel level, LogEvent event, const LogArg* args, uint8_t argc)
+    {
+        EnsureStarted();
+        uint64_t pos = enqueuePos.load(memory_order_relaxed);
+        LogCell* cell;
+        while (true)
+        {
+            cell = &cells[pos & (CAPACITY - 1)];
+            uint64_t seq = cell->sequence.load(memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+            if (diff == 0)
+            {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                dropped.fetch_add(1, memory_order_relaxed); // 缓冲区已满
+                return;
+            }
+            else
+            {
+                pos = enqueuePos.load(memory_order_relaxed);
+            }
+        }
+        cell->level = level;
+        cell->event = event;
+        cell->argc = min<uint8_t>(argc, MAX_ARGS);
+        cell->redactedMask = 0;
+        for (uint8_t i = 0; i < cell->argc; i++)
+        {
+            cell->args[i] = args[i].redacted ? 0 : args[i].value;
+            if (args[i].redacted) cell->redactedMask |= static_cast<uint8_t>(1u << i);
+        }
+        cell->sequence.store(pos + 1, memory_order_release);
+        // 与 Run 中“置 idle 后再检查队列”配对：两边之间都有全序栅栏，不会双方都错过对方
+        atomic_thread_fence(memory_order_seq_cst);
+        if (idle.load(memory_order_relaxed) && idle.exchange(false))
+        {
+            lock_guard<mutex> lock(wakeMutex);
+            wake.notify_one();
+        }
+    }
+
+    // 取出并格式化所有就绪的记录
+    void Drain()
+    {
+        lock_guard<mutex> lock(consumerMutex);
+        DrainLocked();
+    }
+
+    void SetSink(function<void(string_view)> s)
+    {
+        lock_guard<mutex> lock(consumerMutex);
+        sink = move(s);
+    }
+
+    uint64_t Dropped() const { return dropped.load(memory_order_relaxed); }
+
+private:
+    // 调用方持有 consumerMutex
+    void DrainLocked()
+    {
+        string line;
+        while (true)
+        {
+            LogCell* cell = &cells[dequeuePos & (CAPACITY - 1)];
+            if (cell->sequence.load(memory_order_acquire) != dequeuePos + 1)
+                break;
+            Format(*cell, line);
+            cell->sequence.store(dequeuePos + CAPACITY, memory_order_release);
+            dequeuePos++;
+            Emit(line);
+        }
+    }
+
+    void EnsureStarted()
+    {
+        if (started.load(memory_order_acquire)) return;
+        call_once(startOnce, [this] {
+            drainThread = thread([this] { Run(); });
+            started.store(true, memory_order_release);
+        });
+    }
+
+    bool HasReady()
+    {
+        lock_guard<mutex> lock(consumerMutex);
+        return cells[dequeuePos & (CAPACITY - 1)].sequence.load(memory_order_acquire) == dequeuePos + 1;
+    }
+
+    void Run()
+    {
+        unique_lock<mutex> lock(wakeMutex);
+        while (!stopping)
+        {
+            lock.unlock();
+            Drain();
+            idle.store(true, memory_order_relaxed);
+            atomic_thread_fence(memory_order_seq_cst);
+            bool ready = HasReady();
+            lock.lock();
+            if (!ready)
+                wake.wait(lock, [this] { return stopping || !idle.load(memory_order_relaxed); });
+            idle.store(false, memory_order_relaxed);
+        }
+    }
+
+    static void Format(const LogCell& cell, string& line)
+    {
+        const EventInfo& info = EVENTS[static_cast<size_t>(cell.event)];
+        line = "IslandCaller.Core | ";
+        line += info.label;
+        line += " | ";
+        uint8_t arg = 0;
+        for (const char* p = info.format; *p; p++)
+        {
+            bool hex = p[0] == '{' && p[1] == 'x' && p[2] == '}';
+            if (!(p[0] == '{' && p[1] == '}') && !hex)
+            {
+                line.push_back(*p);
+                continue;
+            }
+            p += hex ? 2 : 1;
+            if (arg >= cell.argc) { line += "?"; continue; }
+            if (cell.redactedMask & (1u << arg))
+                line += "<redacted>";
+            else
+            {
+                char buffer[24];
+                snprintf(buffer, sizeof(buffer), hex ? "%llx" : "%lld", static_cast<long long>(cell.args[arg]));
+                line += buffer;
+            }
+            arg++;
+        }
+        line.push_back('\n');
+    }
+
+    void Emit(const string& line)
+    {
+        if (sink)
+            sink(line);
+        else
+        {
+            fwrite(line.data(), 1, line.size(), stdout);
+            fflush(stdout);
+        }
+    }
+
+    LogCell cells[CAPACITY];
+    alignas(64) atomic<uint64_t> enqueuePos{ 0 };
+    alignas(64) uint64_t dequeuePos = 0;
+    atomic<uint64_t> dropped{ 0 };
+
+    mutex consumerMutex;                  // 只在消费者之间（后台线程与 Flush）使用，生产者不加锁
+    function<void(string_view)> sink;
+
+    once_flag startOnce;
+    atomic<bool> started{ false };
+    thread drainThread;
+    mutex wakeMutex;
+    condition_variable wake;
+    bool stopping = false;
+    atomic<bool> idle{ false };           // 后台线程已排空、准备等待
+};
+
+static LogRing ring;
+static atomic<LogLevel> minLevel{ LogLevel::Info };
+
+void Log::SetLevel(LogLevel level)
+{
+    minLevel.store(level, memory_order_relaxed);
+}
+
+LogLevel Log::GetLevel()
+{
+    return minLevel.load(memory_order_relaxed);
+}
+
+bool Log::Enabled(LogLevel level)
+{
+    return level >= minLevel.load(memory_order_relaxed) && level != LogLevel::Off;
+}
+
+void Log::WriteRecord(LogLevel level, LogEvent event, const LogArg* args, uint8_t argc)
+{
+    ring.Push(level, event, args, argc);
+}
+
+void Log::SetSink(function<void(string_view)> sink)
+{
+    ring.SetSink(move(sink));
+}
+
+void Log::Flush()
+{
+    ring.Drain();
+}
+
+uint64_t Log::Dropped()
+{
+    return ring.Dropped();
+}
+
+EXPORT_DLL void SetLogLevel(int level)
+{
+    Log::SetLevel(static_cast<LogLevel>(std::clamp(level, 0, static_cast<int>(LogLevel::Off))));
+}
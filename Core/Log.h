@@ -0,0 +1,105 @@
+// 结构化日志：调用方只写入定长的二进制记录（事件编号 + 最多 6 个整数参数），
+// 记录进入无锁的多生产者单消费者环形缓冲区，由后台线程统一格式化并输出，
+// 因此验证等热点路径上没有区域设置相关的格式化，也没有控制台 I/O。
+//
+// 脱敏规则：参数只能是整数；可能涉及密钥的内容（密钥、验证码、URL 等）只能以 Redact(...) 传入，
+// Redact 在写入端就丢弃其值，格式化时输出 <redacted>，因此任何级别都不会输出密钥材料。
+//
+// 级别可在编译期裁剪：定义 IC_LOG_MIN_LEVEL（默认 0 即 Debug）后，低于该级别的 IC_LOG 调用不生成任何代码；
+// 运行时还可用 Log::SetLevel 进一步提高门槛。缓冲区满时新记录被丢弃并计数，绝不阻塞调用方。
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+enum class LogLevel : uint8_t
+{
+    Debug,
+    Info,
+    Warning,
+    Error,
+    Off,
+};
+
+#ifndef IC_LOG_MIN_LEVEL
+#define IC_LOG_MIN_LEVEL 0
+#endif
+
+// 事件编号与格式表（Log.cpp 中的 EVENTS）一一对应
+enum class LogEvent : uint16_t
+{
+    TotpCreateStart,
+    TotpWriteSecretFailed,
+    TotpCreated,
+    TotpUrlIssued,
+    TotpVerifyStart,
+    TotpReadSecretFailed,
+    TotpCodeChecked,
+    TotpVerified,
+    TotpWrongCode,
+    HelloUnavailable,
+    HelloMakeCredentialFailed,
+    HelloWriteFailed,
+    HelloCredentialWritten,
+    DrawUndone,
+    DrawRedone,
+    ScoreAwarded,
+    Count
+};
+
+// 一个日志参数：整数值，或已被脱敏的占位
+struct LogArg
+{
+    int64_t value = 0;
+    bool redacted = false;
+};
+
+// 脱敏参数：丢弃传入的值，只保留“此处有一个参数”
+template <typename T>
+inline LogArg Redact(const T&)
+{
+    return LogArg{ 0, true };
+}
+
+namespace Log
+{
+    void SetLevel(LogLevel level);
+    LogLevel GetLevel();
+    bool Enabled(LogLevel level);
+
+    void WriteRecord(LogLevel level, LogEvent event, const LogArg* args, uint8_t argc);
+
+    // 格式化后的每一行交给 sink（在后台线程调用），默认写到标准输出；传入空函数恢复默认
+    void SetSink(std::function<void(std::string_view)> sink);
+    // 同步排空缓冲区（测试与进程退出时使用）
+    void Flush();
+    // 因缓冲区满而丢弃的记录数
+    uint64_t Dropped();
+
+    inline LogArg ToArg(const LogArg& arg) { return arg; }
+    template <typename T>
+    inline LogArg ToArg(T value)
+    {
+        static_assert(std::is_integral_v<T> || std::is_enum_v<T>,
+            "Log arguments must be integers; wrap anything that may contain secrets in Redact()");
+        return LogArg{ static_cast<int64_t>(value), false };
+    }
+
+    template <typename... Args>
+    inline void Write(LogLevel level, LogEvent event, Args... args)
+    {
+        static_assert(sizeof...(Args) <= 6, "At most 6 arguments per log record");
+        if (!Enabled(level))
+            return;
+        LogArg packed[sizeof...(Args) + 1] = { ToArg(args)... };
+        WriteRecord(level, event, packed, static_cast<uint8_t>(sizeof...(Args)));
+    }
+}
+
+// 与 IC_LOG_MIN_LEVEL - 1 比较：级别为 uint8_t，写成 >= 0 时 -Wextra 会在每个调用处报 -Wtype-limits
+#define IC_LOG(level, ...) \
+    do { if constexpr (static_cast<int>(level) > IC_LOG_MIN_LEVEL - 1) Log::Write(level, __VA_ARGS__); } while (0)
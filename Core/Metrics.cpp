@@ -0,0 +1,121 @@
+#include "pch.h"
+#include "Metrics.h"
+#include "Log.h"
+#include <memory>
+using namespace std;
+
+/*
+ * 分片方式与 Trace.cpp 的直方图相同：每个线程第一次计数时领取一组计数器，
+ * 线程退出后归还到空闲列表供新线程复用，已累计的数值保留，因此汇总结果不会因线程退出而减少。
+ */
+
+static const char* COUNTER_NAMES[] = {
+    "import_calls", "import_errors", "bytes_parsed", "rows_parsed",
+    "draw_calls", "draw_errors", "students_drawn", "history_clears",
+    "draws_undone", "draws_redone", "state_saves", "state_loads", "state_load_errors",
+    "scores_awarded", "entropy_refills",
+    "totp_create_calls", "totp_create_errors", "totp_verify_calls", "totp_verify_rejected", "totp_verify_errors",
+    "hello_create_calls", "hello_create_errors", "hello_verify_calls", "hello_verify_rejected",
+};
+static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) == static_cast<size_t>(Counter::Count));
+
+static const char* GAUGE_NAMES[] = { "roster_size", "history_size", "undo_depth" };
+static_assert(sizeof(GAUGE_NAMES) / sizeof(GAUGE_NAMES[0]) == static_cast<size_t>(Gauge::Count));
+
+struct alignas(64) ThreadCounters
+{
+    atomic<uint64_t> values[static_cast<size_t>(Counter::Count)] = {};
+};
+
+struct alignas(64) GaugeSlot
+{
+    atomic<uint64_t> value{ 0 };
+};
+
+static mutex registryMutex;
+static vector<unique_ptr<ThreadCounters>> registry; // 所有曾经分配过的分片
+static vector<ThreadCounters*> freeList;            // 已退出线程归还的分片
+static GaugeSlot gauges[static_cast<size_t>(Gauge::Count)];
+
+struct CounterSlot
+{
+    ThreadCounters* counters = nullptr;
+
+    ThreadCounters* Get()
+    {
+        if (!counters)
+        {
+            lock_guard<mutex> lock(registryMutex);
+            if (!freeList.empty())
+            {
+                counters = freeList.back();
+                freeList.pop_back();
+            }
+            else
+            {
+                registry.push_back(make_unique<ThreadCounters>());
+                counters = registry.back().get();
+            }
+        }
+        return counters;
+    }
+
+    ~CounterSlot()
+    {
+        if (counters)
+        {
+            lock_guard<mutex> lock(registryMutex);
+            freeList.push_back(counters);
+        }
+    }
+};
+
+static thread_local CounterSlot slot;
+
+void Metrics::Add(Counter counter, uint64_t delta)
+{
+    // 只有所属线程写入，不需要原子读-改-写
+    atomic<uint64_t>& value = slot.Get()->values[static_cast<size_t>(counter)];
+    value.store(value.load(memory_order_relaxed) + delta, memory_order_relaxed);
+}
+
+void Metrics::Set(Gauge gauge, uint64_t value)
+{
+    gauges[static_cast<size_t>(gauge)].value.store(value, memory_order_relaxed);
+}
+
+Metrics::Snapshot Metrics::Take()
+{
+    Snapshot snapshot = {};
+    {
+        lock_guard<mutex> lock(registryMutex);
+        for (auto& counters : registry)
+            for (size_t i = 0; i < static_cast<size_t>(Counter::Count); i++)
+                snapshot.counters[i] += counters->values[i].load(memory_order_relaxed);
+    }
+    for (size_t i = 0; i < static_cast<size_t>(Gauge::Count); i++)
+        snapshot.gauges[i] = gauges[i].value.load(memory_order_relaxed);
+    return snapshot;
+}
+
+string Metrics::SnapshotJson()
+{
+    Snapshot snapshot = Take();
+    ostringstream oss;
+    oss << "{\"counters\":{";
+    for (size_t i = 0; i < static_cast<size_t>(Counter::Count); i++)
+        oss << (i ? "," : "") << "\"" << COUNTER_NAMES[i] << "\":" << snapshot.counters[i];
+    oss << "},\"gauges\":{";
+    for (size_t i = 0; i < static_cast<size_t>(Gauge::Count); i++)
+        oss << (i ? "," : "") << "\"" << GAUGE_NAMES[i] << "\":" << snapshot.gauges[i];
+    uint64_t roster = snapshot[Gauge::RosterSize];
+    oss << "},\"history_fill\":" << fixed << setprecision(3)
+        << (roster ? static_cast<double>(snapshot[Gauge::HistorySize]) / roster : 0.0)
+        << ",\"log_dropped\":" << Log::Dropped() << "}";
+    return oss.str();
+}
+
+EXPORT_DLL BSTR GetMetricsSnapshot()
+{
+    return Platform::AllocString(Metrics::SnapshotJson());
+}
@@ -0,0 +1,66 @@
+// 运行计数器：记录各导出函数的调用次数、失败次数、解析字节数以及名单规模、已抽取人数等状态，
+// GetMetricsSnapshot 以 JSON 导出，运维无需再翻阅控制台输出。
+//
+// 计数器按线程分片：每个线程写自己那一组（按缓存行对齐，不与其他线程共享缓存行），
+// 写入只是一次 relaxed 读加一次 relaxed 写；导出时汇总所有分片。
+// 名单规模等状态量只在持有 randomMutex 时更新，各占一条缓存行。
+
+#pragma once
+#include <cstdint>
+#include <string>
+
+enum class Counter : uint8_t
+{
+    ImportCalls,            // RandomImport 调用次数
+    ImportErrors,           // 导入失败次数（文件打不开或名单为空）
+    BytesParsed,            // 解析过的名单文件字节数
+    RowsParsed,             // 解析出的数据行数（去重前）
+    DrawCalls,              // 抽取次数，各抽取入口合计：SimpleRandom、AnimatedRandom、分层与空间抽取、RosterDraw 及本地 IPC 的 Draw
+    DrawErrors,             // 抽取失败次数（未导入、人数不足等）
+    StudentsDrawn,          // 累计抽中人数
+    HistoryClears,          // 已抽取历史被清空的次数（手动与自动）
+    DrawsUndone,            // 撤销的抽取或清空次数
+    DrawsRedone,            // 重做次数
+    StateSaves,             // SaveState 导出快照次数
+    StateLoads,             // LoadState 成功恢复次数
+    StateLoadErrors,        // 快照损坏或与当前名单不符
+    ScoresAwarded,          // AwardScore 成功次数
+    EntropyRefills,         // 熵池用掉的系统随机数批次（每批 Entropy::BATCH 字节，含后台预读后被取用的批次）
+    TotpCreateCalls,
+    TotpCreateErrors,
+    TotpVerifyCalls,
+    TotpVerifyRejected,     // 验证码错误
+    TotpVerifyErrors,       // 读取密钥失败
+    HelloCreateCalls,
+    HelloCreateErrors,
+    HelloVerifyCalls,
+    HelloVerifyRejected,
+    Count
+};
+
+enum class Gauge : uint8_t
+{
+    RosterSize,             // 当前名单人数
+    HistorySize,            // 本轮已抽取人数
+    UndoDepth,              // 可撤销的记录数
+    Count
+};
+
+namespace Metrics
+{
+    void Add(Counter counter, uint64_t delta = 1);
+    void Set(Gauge gauge, uint64_t value);
+
+    struct Snapshot
+    {
+        uint64_t counters[static_cast<size_t>(Counter::Count)];
+        uint64_t gauges[static_cast<size_t>(Gauge::Count)];
+
+        uint64_t operator[](Counter counter) const { return counters[static_cast<size_t>(counter)]; }
+        uint64_t operator[](Gauge gauge) const { return gauges[static_cast<size_t>(gauge)]; }
+    };
+
+    // 汇总所有线程的计数器
+    Snapshot Take();
+    std::string SnapshotJson();
+}
@@ -0,0 +1,53 @@
+// 平台抽象层：把 Core 依赖的系统能力（路径、密钥存储、字符串返回、界面提示、身份验证器）
+// 收敛到一个很薄的接口后面，Windows 实现见 PlatformWin.cpp，POSIX 实现见 PlatformPosix.cpp。
+// 名单与 TOTP 的逻辑只依赖这里的函数，因此可以在 Linux 上编译、测试和做基准测试。
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+// POSIX 下没有 OLE 自动化字符串，用以 NUL 结尾的 wchar_t 缓冲区代替，
+// 由 Platform::AllocString 分配、Platform::FreeString 释放
+typedef wchar_t* BSTR;
+#endif
+
+namespace Platform
+{
+    // 名单目录：Windows 为 %APPDATA%\IslandCaller\Profile\，POSIX 为 $XDG_CONFIG_HOME/IslandCaller/Profile/
+    // 设置环境变量 ISLANDCALLER_HOME 后改为 $ISLANDCALLER_HOME/Profile/（测试与基准测试使用）
+    std::string GetProfileDirectory();
+    // 名单文件的完整路径，filename 不含目录
+    std::string GetProfilePath(const std::string& filename);
+
+    // 密钥存储：Windows 为 HKCU\SOFTWARE\IslandCaller\Security\SecretKey 下的 REG_BINARY 值，
+    // POSIX 为配置目录下 Security/<name> 文件（权限 0600）
+    // 返回 0 表示成功，否则返回系统错误码
+    long WriteSecret(const std::wstring& name, const std::vector<uint8_t>& data);
+    long ReadSecret(const std::wstring& name, std::vector<uint8_t>& data);
+
+    // 字符串返回：把 UTF-8 字符串转换为调用方负责释放的 BSTR
+    BSTR AllocString(const std::string& utf8);
+    void FreeString(BSTR str);
+
+    // 本地 IPC 服务的默认端点：Windows 为按用户区分的命名管道 \\.\pipe\IslandCaller-<用户 SID>，
+    // POSIX 为配置目录下的 Unix 域套接字 ipc.sock
+    std::string GetIpcEndpoint();
+#ifdef _WIN32
+    // 当前进程用户的 SID 字符串（S-1-5-...），取不到时返回空串；命名管道的名称与 DACL 使用
+    std::wstring CurrentUserSid();
+#endif
+
+    // 界面提示：Windows 弹出 MessageBox，POSIX 输出到 stderr
+    void ShowError(const std::wstring& message);
+
+    // 系统随机数：BCryptGenRandom / getrandom，失败返回 false
+    bool GenRandom(uint8_t* buffer, size_t length);
+
+    // 平台身份验证器（Windows Hello / WebAuthn），POSIX 下不可用
+    bool AuthenticatorAvailable();
+    bool AuthenticatorMakeCredential(const std::vector<uint8_t>& userId, const std::vector<uint8_t>& challenge, std::vector<uint8_t>& credentialId);
+    bool AuthenticatorGetAssertion(const std::vector<uint8_t>& credentialId, const std::vector<uint8_t>& challenge);
+}
@@ -0,0 +1,147 @@
+// 平台抽象层的 POSIX 实现（Linux 上的测试、基准测试与命令行工具使用）
+
+#include "pch.h"
+#include "Encoding.h"
+#ifndef _WIN32
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/random.h>
+#endif
+using namespace std;
+
+// 配置根目录：$ISLANDCALLER_HOME，否则 $XDG_CONFIG_HOME/IslandCaller，否则 ~/.config/IslandCaller
+static string GetRootDirectory()
+{
+    const char* home = getenv("ISLANDCALLER_HOME");
+    if (home && *home)
+        return string(home);
+    const char* xdg = getenv("XDG_CONFIG_HOME");
+    if (xdg && *xdg)
+        return string(xdg) + "/IslandCaller";
+    const char* user = getenv("HOME");
+    return string(user ? user : ".") + "/.config/IslandCaller";
+}
+
+// 逐级创建目录，已存在时忽略
+static void MakeDirectories(const string& path)
+{
+    for (size_t pos = path.find('/', 1); ; pos = path.find('/', pos + 1))
+    {
+        mkdir(path.substr(0, pos).c_str(), 0700);
+        if (pos == string::npos) break;
+    }
+}
+
+static string SecretPath(const wstring& name)
+{
+    return GetRootDirectory() + "/Security/" + WideToUtf8(name);
+}
+
+string Platform::GetProfileDirectory()
+{
+    return GetRootDirectory() + "/Profile/";
+}
+
+string Platform::GetProfilePath(const string& filename)
+{
+    return GetProfileDirectory() + filename;
+}
+
+string Platform::GetIpcEndpoint()
+{
+    MakeDirectories(GetRootDirectory());
+    return GetRootDirectory() + "/ipc.sock";
+}
+
+long Platform::WriteSecret(const wstring& name, const vector<uint8_t>& data)
+{
+    MakeDirectories(GetRootDirectory() + "/Security");
+    string path = SecretPath(name);
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0)
+        return errno;
+    size_t written = 0;
+    while (written < data.size())
+    {
+        ssize_t n = write(fd, data.data() + written, data.size() - written);
+        if (n < 0)
+        {
+            if (errno == EINTR) continue;
+            long err = errno;
+            close(fd);
+            return err;
+        }
+        written += static_cast<size_t>(n);
+    }
+    close(fd);
+    return 0;
+}
+
+long Platform::ReadSecret(const wstring& name, vector<uint8_t>& data)
+{
+    ifstream file(SecretPath(name), ios::binary);
+    if (!file)
+        return ENOENT;
+    data.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    return 0;
+}
+
+BSTR Platform::AllocString(const string& utf8)
+{
+    wstring wide = Utf8ToWide(utf8);
+    BSTR out = static_cast<BSTR>(malloc((wide.size() + 1) * sizeof(wchar_t)));
+    if (out)
+        memcpy(out, wide.c_str(), (wide.size() + 1) * sizeof(wchar_t));
+    return out;
+}
+
+void Platform::FreeString(BSTR str)
+{
+    free(str);
+}
+
+void Platform::ShowError(const wstring& message)
+{
+    cerr << WideToUtf8(message) << "\n";
+}
+
+bool Platform::GenRandom(uint8_t* buffer, size_t length)
+{
+#if defined(__linux__)
+    size_t filled = 0;
+    while (filled < length)
+    {
+        ssize_t n = getrandom(buffer + filled, length - filled, 0);
+        if (n < 0)
+        {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        filled += static_cast<size_t>(n);
+    }
+    return true;
+#else
+    ifstream urandom("/dev/urandom", ios::binary);
+    return static_cast<bool>(urandom.read(reinterpret_cast<char*>(buffer), static_cast<streamsize>(length)));
+#endif
+}
+
+bool Platform::AuthenticatorAvailable()
+{
+    return false;
+}
+
+bool Platform::AuthenticatorMakeCredential(const vector<uint8_t>&, const vector<uint8_t>&, vector<uint8_t>&)
+{
+    return false;
+}
+
+bool Platform::AuthenticatorGetAssertion(const vector<uint8_t>&, const vector<uint8_t>&)
+{
+    return false;
+}
+#endif
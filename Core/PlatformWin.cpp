@@ -0,0 +1,219 @@
+// 平台抽象层的 Windows 实现
+
+#include "pch.h"
+#include "Log.h"
+#include "Encoding.h"
+#ifdef _WIN32
+#pragma comment(lib, "webauthn.lib")
+#pragma comment(lib, "bcrypt.lib")
+#pragma comment(lib, "advapi32.lib")
+#include <sddl.h>
+using namespace std;
+
+static constexpr LPCWSTR SECRET_REG_PATH = L"SOFTWARE\\IslandCaller\\Security\\SecretKey";
+
+string Platform::GetProfileDirectory()
+{
+    char buffer[MAX_PATH];
+    DWORD len = GetEnvironmentVariableA("ISLANDCALLER_HOME", buffer, MAX_PATH);
+    if (len > 0 && len < MAX_PATH)
+        return string(buffer) + "\\Profile\\";
+    char appDataPath[MAX_PATH];
+    SHGetFolderPathA(NULL, CSIDL_APPDATA, NULL, 0, appDataPath);
+    return string(appDataPath) + "\\IslandCaller\\Profile\\";
+}
+
+string Platform::GetProfilePath(const string& filename)
+{
+    return GetProfileDirectory() + filename;
+}
+
+wstring Platform::CurrentUserSid()
+{
+    HANDLE token;
+    if (!OpenProcessToken(GetCurrentProcess(), TOKEN_QUERY, &token))
+        return wstring();
+    DWORD size = 0;
+    GetTokenInformation(token, TokenUser, NULL, 0, &size);
+    vector<uint8_t> buffer(size);
+    wstring sid;
+    LPWSTR text = NULL;
+    if (size > 0 && GetTokenInformation(token, TokenUser, buffer.data(), size, &size) &&
+        ConvertSidToStringSidW(reinterpret_cast<TOKEN_USER*>(buffer.data())->User.Sid, &text))
+    {
+        sid = text;
+        LocalFree(text);
+    }
+    CloseHandle(token);
+    return sid;
+}
+
+// 管道名按用户区分：同一台机器上的其他用户各自使用自己的端点
+string Platform::GetIpcEndpoint()
+{
+    return "\\\\.\\pipe\\IslandCaller-" + WideToUtf8(CurrentUserSid());
+}
+
+long Platform::WriteSecret(const wstring& name, const vector<uint8_t>& data)
+{
+    HKEY hKey;
+    LONG res = RegCreateKeyExW(HKEY_CURRENT_USER, SECRET_REG_PATH, 0, NULL,
+        REG_OPTION_NON_VOLATILE, KEY_WRITE, NULL, &hKey, NULL);
+    if (res != ERROR_SUCCESS)
+        return res;
+    res = RegSetValueExW(hKey, name.c_str(), 0, REG_BINARY,
+        reinterpret_cast<const BYTE*>(data.data()),
+        static_cast<DWORD>(data.size()));
+    RegCloseKey(hKey);
+    return res;
+}
+
+long Platform::ReadSecret(const wstring& name, vector<uint8_t>& data)
+{
+    HKEY hKey;
+    LONG res = RegOpenKeyExW(HKEY_CURRENT_USER, SECRET_REG_PATH, 0, KEY_READ, &hKey);
+    if (res != ERROR_SUCCESS)
+        return res;
+
+    DWORD type = 0;
+    DWORD dataSize = 0;
+    res = RegGetValueW(hKey, NULL, name.c_str(), RRF_RT_REG_BINARY, &type, NULL, &dataSize);
+    if (res != ERROR_SUCCESS || type != REG_BINARY) {
+        RegCloseKey(hKey);
+        return res != ERROR_SUCCESS ? res : ERROR_INVALID_DATATYPE;
+    }
+
+    data.resize(dataSize);
+    res = RegGetValueW(hKey, NULL, name.c_str(), RRF_RT_REG_BINARY, NULL, data.data(), &dataSize);
+    RegCloseKey(hKey);
+    data.resize(dataSize);
+    return res;
+}
+
+BSTR Platform::AllocString(const string& utf8)
+{
+    if (utf8.empty())
+        return SysAllocString(L"");
+    int len = MultiByteToWideChar(CP_UTF8, 0, utf8.data(), static_cast<int>(utf8.size()), NULL, 0);
+    BSTR out = SysAllocStringLen(NULL, len);
+    if (out)
+        MultiByteToWideChar(CP_UTF8, 0, utf8.data(), static_cast<int>(utf8.size()), out, len);
+    return out;
+}
+
+void Platform::FreeString(BSTR str)
+{
+    SysFreeString(str);
+}
+
+void Platform::ShowError(const wstring& message)
+{
+    MessageBox(NULL, message.c_str(), L"Error", MB_ICONERROR);
+}
+
+bool Platform::GenRandom(uint8_t* buffer, size_t length)
+{
+    return BCryptGenRandom(NULL, buffer, static_cast<ULONG>(length), BCRYPT_USE_SYSTEM_PREFERRED_RNG) == 0;
+}
+
+bool Platform::AuthenticatorAvailable()
+{
+    BOOL available = FALSE;
+    return SUCCEEDED(WebAuthNIsUserVerifyingPlatformAuthenticatorAvailable(&available)) && available;
+}
+
+bool Platform::AuthenticatorMakeCredential(const vector<uint8_t>& userId, const vector<uint8_t>& challenge, vector<uint8_t>& credentialId)
+{
+    const wstring rpId = L"IslandCaller.App"; // 必须与验证时一致
+    const wstring rpName = L"IslandCaller";
+
+    // Relying Party 信息
+    WEBAUTHN_RP_ENTITY_INFORMATION rpInfo = { sizeof(rpInfo) };
+    rpInfo.pwszId = rpId.c_str();
+    rpInfo.pwszName = rpName.c_str();
+
+    // 用户信息
+    WEBAUTHN_USER_ENTITY_INFORMATION userInfo = { sizeof(userInfo) };
+    userInfo.pbId = const_cast<PBYTE>(userId.data());
+    userInfo.cbId = static_cast<DWORD>(userId.size());
+    userInfo.pwszName = L"Admin@IslandCaller.App";
+    userInfo.pwszDisplayName = L"Administrator";
+
+    // 公钥算法参数
+    WEBAUTHN_COSE_CREDENTIAL_PARAMETER coseParam = { sizeof(coseParam) };
+    coseParam.pwszCredentialType = WEBAUTHN_CREDENTIAL_TYPE_PUBLIC_KEY;
+    coseParam.lAlg = WEBAUTHN_COSE_ALGORITHM_ECDSA_P256_WITH_SHA256;
+    WEBAUTHN_COSE_CREDENTIAL_PARAMETERS coseParams = { 1, &coseParam };
+
+    WEBAUTHN_CLIENT_DATA clientData = { sizeof(clientData) };
+    clientData.pwszHashAlgId = WEBAUTHN_HASH_ALGORITHM_SHA_256;
+    clientData.pbClientDataJSON = const_cast<PBYTE>(challenge.data());
+    clientData.cbClientDataJSON = static_cast<DWORD>(challenge.size());
+
+    // 创建 Passkey
+    WEBAUTHN_CREDENTIAL_ATTESTATION* pAttestation = nullptr;
+    HRESULT hr = WebAuthNAuthenticatorMakeCredential(
+        GetConsoleWindow(),
+        &rpInfo,
+        &userInfo,
+        &coseParams,
+        &clientData,
+        nullptr,
+        &pAttestation
+    );
+
+    if (FAILED(hr) || !pAttestation)
+    {
+        IC_LOG(LogLevel::Error, LogEvent::HelloMakeCredentialFailed, static_cast<uint32_t>(hr));
+        return false;
+    }
+
+    credentialId.assign(pAttestation->pbCredentialId, pAttestation->pbCredentialId + pAttestation->cbCredentialId);
+    WebAuthNFreeCredentialAttestation(pAttestation);
+    return true;
+}
+
+bool Platform::AuthenticatorGetAssertion(const vector<uint8_t>& credentialId, const vector<uint8_t>& challenge)
+{
+    // 固定 RP ID（必须与注册时一致）
+    const wstring rpId = L"IslandCaller.App";
+
+    WEBAUTHN_CLIENT_DATA clientData = { sizeof(clientData) };
+    clientData.pwszHashAlgId = WEBAUTHN_HASH_ALGORITHM_SHA_256;
+    clientData.pbClientDataJSON = const_cast<PBYTE>(challenge.data());
+    clientData.cbClientDataJSON = static_cast<DWORD>(challenge.size());
+
+    // 构造允许的凭证
+    WEBAUTHN_CREDENTIAL_EX allowCred = { sizeof(allowCred) };
+    allowCred.dwVersion = WEBAUTHN_CREDENTIAL_EX_CURRENT_VERSION;
+    allowCred.cbId = (DWORD)credentialId.size();
+    allowCred.pbId = const_cast<PBYTE>(credentialId.data());
+    allowCred.pwszCredentialType = WEBAUTHN_CREDENTIAL_TYPE_PUBLIC_KEY;
+    allowCred.dwTransports = WEBAUTHN_CTAP_TRANSPORT_INTERNAL;
+
+    WEBAUTHN_CREDENTIALS allowList = { 1, (PWEBAUTHN_CREDENTIAL)&allowCred };
+
+    // 验证选项（新版结构）
+    WEBAUTHN_AUTHENTICATOR_GET_ASSERTION_OPTIONS options = { sizeof(options) };
+    options.dwVersion = WEBAUTHN_AUTHENTICATOR_GET_ASSERTION_OPTIONS_CURRENT_VERSION;
+    options.dwTimeoutMilliseconds = 60000;
+    options.CredentialList = allowList;
+    options.dwUserVerificationRequirement = WEBAUTHN_USER_VERIFICATION_REQUIREMENT_REQUIRED;
+
+    // 调用验证 API
+    WEBAUTHN_ASSERTION* pAssertion = nullptr;
+    HRESULT hr = WebAuthNAuthenticatorGetAssertion(
+        GetConsoleWindow(),
+        rpId.c_str(),
+        &clientData,
+        &options,
+        &pAssertion
+    );
+
+    bool success = SUCCEEDED(hr) && pAssertion;
+    if (pAssertion)
+        WebAuthNFreeAssertion(pAssertion);
+
+    return success;
+}
+#endif
@@ -1,181 +1,383 @@
 #include "pch.h"
+#include "RandomEngine.h"
+#include "Animation.h"
+#include "Trace.h"
+#include "Metrics.h"
+#include "Encoding.h"
+#include "Log.h"
+#include "EntropyPool.h"
+#include "VerifiableSession.h"
 using namespace std;
 
 // 全局变量
-vector<string> students;              // 学生名单
-bool isInitialized = false;           // 是否已初始化
-unordered_set<string> RandomHashSet;  // 用于存储已抽取的学生名单（防止重复）
+RandomEngine engine;                  // 抽取引擎：名单、已抽取历史与抽取算法（见 RandomEngine.cpp）
 mutex randomMutex;                    // 线程安全保护：防止多线程并发访问导致的数据竞争
+VerifiableSession session;            // 可验证抽取会话（见 VerifiableSession.h），只在持有 randomMutex 时访问
 
-/*
- * 随机选择算法改进说明：
- * 
- * 问题1：随机数生成器种子固定
- * 原实现：使用全局的 random_device 和 mt19937，只在 DLL 加载时初始化一次
- * 改进：每次调用 SimpleRandom 时重新创建 random_device 和 mt19937
- * 效果：确保每次调用都有真正的随机性，不会因为种子固定而产生可预测的序列
- * 
- * 问题2：低效的重试机制
- * 原实现：随机选择后如果发现重复，就递减计数器重新选择
- * 缺点：当已抽取学生接近总数时，可能需要大量重试
- * 改进：使用 Fisher-Yates 洗牌算法，预先构建可用学生列表
- * 效果：时间复杂度从最坏 O(∞) 降低到 O(n)，保证性能稳定
- * 
- * 问题3：缺乏线程安全
- * 原实现：全局变量无保护，多线程访问会导致数据竞争
- * 改进：使用 mutex 和 lock_guard 保护所有共享状态
- * 效果：支持多线程安全调用
- */
-
-EXPORT_DLL int RandomImport(const wchar_t* filenameW)
+static int ImportFile(const string& path, const RosterColumns& columns = {})
 {
+    IC_TRACE_SPAN(TraceOp::Import);
     lock_guard<mutex> lock(randomMutex); // 线程安全保护
-    students.clear(); // 清空学生名单
-    RandomHashSet.clear(); // 清空已抽取的学生名单
+    int result = engine.Import(path, columns);
+    session.Interrupt();
+    Metrics::Add(Counter::ImportCalls);
+    if (result != 0) Metrics::Add(Counter::ImportErrors);
+    Metrics::Set(Gauge::RosterSize, engine.Size());
+    Metrics::Set(Gauge::HistorySize, engine.HistorySize());
+    Metrics::Set(Gauge::UndoDepth, engine.UndoDepth());
+    return result;
+}
+
+static string ProfileFile(const wchar_t* filenameW)
+{
     wstring wstr(filenameW);
     string filename(wstr.begin(), wstr.end());
     filename += ".csv";
-    char appDataPath[MAX_PATH];
-    SHGetFolderPathA(NULL, CSIDL_APPDATA, NULL, 0, appDataPath);
-    string filePath = string(appDataPath) + "\\IslandCaller\\Profile\\" + filename;
-    ifstream file(filePath);
-    if (!file) {
-        MessageBox(NULL, (L"IslandCaller: Failed to open: " + wstring(filename.begin(), filename.end())).c_str(), L"Error", MB_ICONERROR);
-        return -1;
-    }
-    string name;
-    unordered_set<string> ImportHashSet;
-    string line;
-    getline(file, line); // 不保存第一行标题
-    while (getline(file, line))
-    {
-        stringstream ss(line);
-        string token;
-        int columnIndex = 0;
-        name.clear();
+    return Platform::GetProfilePath(filename);
+}
 
-        while (getline(ss, token, ','))
-        {
-            if (columnIndex == 1)
-            {
-                if (!token.empty() && token.front() == '"')
-                    token.erase(0, 1);
-                if (!token.empty() && token.back() == '"')
-                    token.pop_back();
-                name = token;
-                break;
-            }
-            columnIndex++;
-        }
+EXPORT_DLL int RandomImport(const wchar_t* filenameW)
+{
+    return ImportFile(ProfileFile(filenameW));
+}
 
-        if (students.size() >= students.max_size()) {
-            MessageBox(NULL, L"IslandCaller: Student list size exceeds maximum capacity!", L"Error", MB_ICONERROR);
-            file.close();
-            return -1;
-        }
+// 导入名单并按标题为 groupColumnW 的列分组（如“小组”“排”），供 StratifiedRandom 使用
+EXPORT_DLL int RandomImportGrouped(const wchar_t* filenameW, const wchar_t* groupColumnW)
+{
+    RosterColumns columns;
+    columns.group = WideToUtf8(groupColumnW);
+    return ImportFile(ProfileFile(filenameW), columns);
+}
 
-        name.erase(0, name.find_first_not_of(" \t\n\r"));
-        name.erase(name.find_last_not_of(" \t\n\r") + 1);
+// 导入名单并按标题读取分组列与座位行、列号列（供 SpatialRandom 使用），传入空指针或空串的列不读取
+EXPORT_DLL int RandomImportColumns(const wchar_t* filenameW, const wchar_t* groupColumnW,
+    const wchar_t* rowColumnW, const wchar_t* columnColumnW)
+{
+    auto column = [](const wchar_t* w) { return w ? WideToUtf8(w) : string(); };
+    return ImportFile(ProfileFile(filenameW), { column(groupColumnW), column(rowColumnW), column(columnColumnW) });
+}
 
-        if (name.empty()) continue;
-        if (ImportHashSet.find(name) != ImportHashSet.end()) continue;
+// 按完整路径导入名单（命令行工具使用，不经过名单目录）
+EXPORT_DLL int RandomImportFromPath(const wchar_t* pathW)
+{
+    return ImportFile(WideToUtf8(pathW));
+}
 
-        students.push_back(name);
-        ImportHashSet.insert(name);
-    }
-    file.close();
+EXPORT_DLL void ClearHistory()
+{
+    lock_guard<mutex> lock(randomMutex); // 线程安全保护
+    engine.ClearHistory(); // 清空已抽取的学生名单
+    session.Record("clear");
+    Metrics::Add(Counter::HistoryClears);
+    Metrics::Set(Gauge::HistorySize, 0);
+    Metrics::Set(Gauge::UndoDepth, engine.UndoDepth());
+}
 
-    // 检查名单是否为空
-    if (students.empty()) {
-        MessageBox(NULL, L"IslandCaller: Namelist is empty!", L"Error", MB_ICONERROR);
-        return -1;
-    }
+// 设置冷却人次：最近被抽中的 picks 人次内的学生不会再被 SimpleRandom 抽中（跨轮次），0 表示关闭
+EXPORT_DLL void SetCooldown(const int picks)
+{
+    lock_guard<mutex> lock(randomMutex); // 线程安全保护
+    engine.SetCooldown(static_cast<size_t>(max(picks, 0)));
+    session.Record("cooldown", { max(picks, 0) });
+    Metrics::Set(Gauge::UndoDepth, 0);
+}
+
+// 随机数模式：0 为快速（xoshiro256**，默认），1 为安全（ChaCha20，已公布的结果无助于预测之后的抽取），其他值忽略
+// 作用于全局名单此后的全部抽取，导入名单后保留
+EXPORT_DLL void SetRandomMode(const int mode)
+{
+    if (mode != static_cast<int>(RandomMode::Fast) && mode != static_cast<int>(RandomMode::Secure))
+        return;
+    lock_guard<mutex> lock(randomMutex); // 线程安全保护
+    engine.SetRandomMode(static_cast<RandomMode>(mode));
+}
 
-    ImportHashSet.clear(); // 清空导入的哈希集
-    isInitialized = true;
+// 互斥约束：nameA 与 nameB 不会在同一次 SimpleRandom 中被同时抽中；成功返回 0，查无此人或两人相同返回 -1
+// 约束随名单导入清空，重新导入后需再次设置
+EXPORT_DLL int AddExclusion(const wchar_t* nameAW, const wchar_t* nameBW)
+{
+    string nameA = nameAW ? WideToUtf8(nameAW) : string();
+    string nameB = nameBW ? WideToUtf8(nameBW) : string();
+    lock_guard<mutex> lock(randomMutex); // 线程安全保护
+    if (!engine.IsInitialized())
+        return -1;
+    int a = engine.Find(nameA), b = engine.Find(nameB);
+    if (!engine.AddExclusion(a, b))
+        return -1;
+    session.Record("exclude", { a, b });
     return 0;
 }
 
-EXPORT_DLL void ClearHistory()
+EXPORT_DLL void ClearExclusions()
 {
     lock_guard<mutex> lock(randomMutex); // 线程安全保护
-    RandomHashSet.clear(); // 清空已抽取的学生名单
+    engine.ClearExclusions();
+    session.Record("unexclude");
 }
 
-//点名器函数
-EXPORT_DLL BSTR SimpleRandom(const int number)
+// 加锁调用 draw 抽取并记录计数，再把被抽中的姓名以两个空格分隔写入 output；
+// 抽取成功时仍在锁内以被抽中的下标调用 onDrawn。
+// draw 使用传入的随机数流：可验证会话进行中时为会话流，并以 op、args 记下本次抽取，否则为当前线程的流
+template <class DrawFunc, class OnDrawn>
+static DrawStatus DrawLocked(string& output, const char* op, initializer_list<int> args, DrawFunc draw, OnDrawn onDrawn)
 {
+    IC_TRACE_SPAN(TraceOp::Draw);
     lock_guard<mutex> lock(randomMutex); // 线程安全保护
-    std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter; // UTF-8 => UTF-16
-    if (!isInitialized)
+    output.clear();
+    vector<int> picked;
+    bool roundFinished = engine.IsInitialized() && engine.HistorySize() >= engine.Size(); // 本次抽取会先自动清空历史
+    RandomStream& gen = session.Active() ? session.Stream() : Rng::ThreadStream(engine.Mode());
+    DrawStatus status = draw(picked, gen);
+    session.Record(op, args, status, picked);
+    Metrics::Add(Counter::DrawCalls);
+    if (status != DrawStatus::Ok)
+    {
+        Metrics::Add(Counter::DrawErrors);
+        return status;
+    }
+    if (roundFinished) Metrics::Add(Counter::HistoryClears);
+    Metrics::Add(Counter::StudentsDrawn, picked.size());
+    Metrics::Set(Gauge::HistorySize, engine.HistorySize());
+    Metrics::Set(Gauge::UndoDepth, engine.UndoDepth());
+
+    for (size_t i = 0; i < picked.size(); i++)
     {
-        return SysAllocString(converter.from_bytes("Not Initialized!").c_str());
+        // 添加到输出
+        output += engine.Name(picked[i]);
+
+        // 添加分隔符（除了最后一个学生）
+        if (i + 1 < picked.size())
+        {
+            output += "  ";
+        }
     }
-    string output = "";
-    if (number > students.size())
+    onDrawn(picked);
+    return DrawStatus::Ok;
+}
+
+template <class DrawFunc>
+static DrawStatus DrawLocked(string& output, const char* op, initializer_list<int> args, DrawFunc draw)
+{
+    return DrawLocked(output, op, args, draw, [](const vector<int>&) {});
+}
+
+DrawStatus DrawNames(int number, string& output)
+{
+    return DrawLocked(output, "draw", { number },
+        [&](vector<int>& picked, RandomStream& gen) { return engine.Draw(number, picked, gen); });
+}
+
+DrawStatus DrawStratifiedNames(StratifyMode mode, int number, string& output)
+{
+    return DrawLocked(output, "stratified", { static_cast<int>(mode), number },
+        [&](vector<int>& picked, RandomStream& gen) { return engine.DrawStratified(mode, number, picked, gen); });
+}
+
+DrawStatus DrawSpatialNames(SpatialMode mode, int number, string& output)
+{
+    return DrawLocked(output, "spatial", { static_cast<int>(mode), number },
+        [&](vector<int>& picked, RandomStream& gen) { return engine.DrawSpatial(mode, number, picked, gen); });
+}
+
+// 带滚动动画的点名：抽取 number 人，并生成 frames 帧、共 durationMs 毫秒的动画
+// slots 需容纳 frames * number 项，第 f 帧第 s 个位置显示动画名单中的第 slots[f * number + s] 项；
+// timesMs 需容纳 frames 项，为各帧开始显示的时刻（缓出，末帧为抽取结果）。
+// 成功返回 0，names 为动画名单（以换行分隔，姓名中可能含有连续空格而不会含有换行，前 number 项即抽取结果）；
+// 失败返回 -1，names 为提示文本
+EXPORT_DLL int AnimatedRandom(const int number, const int frames, const int durationMs, int* slots, int* timesMs, BSTR* names)
+{
+    if (!names)
+        return -1;
+    if (!slots || !timesMs || frames < 1 || durationMs < 0)
     {
-        return SysAllocString(converter.from_bytes("Not enough students!").c_str());// 如果请求的数量超过学生名单，则退出
+        *names = Platform::AllocString("Invalid animation parameters!");
+        return -1;
     }
-    
-    // 如果已抽取的学生数量等于或超过总学生数，清空历史记录
-    if (RandomHashSet.size() >= students.size())
+    static Animation animation; // 只在持有 randomMutex 时使用，数组容量跨调用复用
+    string output;
+    DrawStatus status = DrawLocked(output, "draw", { number },
+        [&](vector<int>& picked, RandomStream& gen) { return engine.Draw(number, picked, gen); },
+        [&](const vector<int>& picked) {
+            // 诱饵不影响结果，始终使用当前线程的流，可验证会话的记录与不带动画的抽取相同
+            BuildAnimation(engine, picked, frames, durationMs, animation, Rng::ThreadStream(engine.Mode()));
+            output.clear();
+            for (size_t i = 0; i < animation.students.size(); i++)
+            {
+                if (i > 0) output += '\n';
+                output += engine.Name(animation.students[i]);
+            }
+            copy(animation.slots.begin(), animation.slots.end(), slots);
+            copy(animation.times.begin(), animation.times.end(), timesMs);
+        });
+    if (status != DrawStatus::Ok)
     {
-        RandomHashSet.clear();
+        *names = Platform::AllocString(DrawStatusMessage(status));
+        return -1;
     }
-    
-    // 创建可用学生索引列表（未被抽取的学生）
-    vector<int> availableIndices;
-    availableIndices.reserve(students.size() - RandomHashSet.size());
-    for (size_t i = 0; i < students.size(); i++)
+    *names = Platform::AllocString(output);
+    return 0;
+}
+
+// 撤销最近一次抽取（或清空），返回被放回的学生，以两个空格分隔；撤销的是清空时返回空串
+EXPORT_DLL BSTR UndoDraw()
+{
+    lock_guard<mutex> lock(randomMutex); // 线程安全保护
+    vector<int> reverted;
+    if (!engine.Undo(reverted))
+        return Platform::AllocString("Nothing to undo!");
+    session.Record("undo");
+    Metrics::Add(Counter::DrawsUndone);
+    Metrics::Set(Gauge::HistorySize, engine.HistorySize());
+    Metrics::Set(Gauge::UndoDepth, engine.UndoDepth());
+    IC_LOG(LogLevel::Info, LogEvent::DrawUndone, reverted.size(), engine.UndoDepth());
+    string output;
+    for (int index : reverted)
+        output += (output.empty() ? "" : "  ") + engine.Name(index);
+    return Platform::AllocString(output);
+}
+
+// 重做最近一次撤销，返回重新被抽中的学生
+EXPORT_DLL BSTR RedoDraw()
+{
+    lock_guard<mutex> lock(randomMutex); // 线程安全保护
+    vector<int> reapplied;
+    if (!engine.Redo(reapplied))
+        return Platform::AllocString("Nothing to redo!");
+    session.Record("redo");
+    Metrics::Add(Counter::DrawsRedone);
+    Metrics::Set(Gauge::HistorySize, engine.HistorySize());
+    Metrics::Set(Gauge::UndoDepth, engine.UndoDepth());
+    IC_LOG(LogLevel::Info, LogEvent::DrawRedone, reapplied.size(), engine.RedoDepth());
+    string output;
+    for (int index : reapplied)
+        output += (output.empty() ? "" : "  ") + engine.Name(index);
+    return Platform::AllocString(output);
+}
+
+// 把当前名单的抽取状态写入 buffer（格式见 RandomEngine.cpp），返回快照字节数；
+// buffer 为空或 capacity 不足时不写入，只返回所需字节数，调用方按此分配后再调用一次
+EXPORT_DLL int SaveState(uint8_t* buffer, const int capacity)
+{
+    lock_guard<mutex> lock(randomMutex); // 线程安全保护
+    string state;
+    engine.SaveState(state);
+    if (buffer && capacity >= static_cast<int>(state.size()))
     {
-        if (RandomHashSet.find(students[i]) == RandomHashSet.end())
-        {
-            availableIndices.push_back(i);
-        }
+        memcpy(buffer, state.data(), state.size());
+        Metrics::Add(Counter::StateSaves);
     }
-    
-    // 使用高质量随机数生成器进行洗牌
-    // 每次调用时使用新的随机种子确保真正的随机性
-    // 注意：虽然每次创建新的 random_device 和 mt19937 有一定开销，
-    // 但这是确保真正随机性的必要代价，避免了原实现中种子固定的问题
-    random_device rd;
-    mt19937 gen(rd());
-    
-    // 验证有足够的可用学生
-    // 注意：此检查是必要的，因为在清空 RandomHashSet 后（第123行），
-    // availableIndices 会包含所有学生，仍需确保数量足够
-    if (number > static_cast<int>(availableIndices.size()))
+    return static_cast<int>(state.size());
+}
+
+// 从快照恢复抽取状态：成功返回 0，尚未导入名单返回 -1，快照损坏或版本不符返回 -2，快照不属于当前名单返回 -3
+EXPORT_DLL int LoadState(const uint8_t* data, const int length)
+{
+    lock_guard<mutex> lock(randomMutex); // 线程安全保护
+    RandomEngine::StateError error = data && length > 0
+        ? engine.LoadState(string_view(reinterpret_cast<const char*>(data), length))
+        : RandomEngine::StateError::Corrupted;
+    if (error != RandomEngine::StateError::Ok)
     {
-        return SysAllocString(converter.from_bytes("Not enough available students!").c_str());
+        Metrics::Add(Counter::StateLoadErrors);
+        return -static_cast<int>(error);
     }
-    
-    // 使用 Fisher-Yates 洗牌算法随机选择学生
-    // 算法原理：从可用学生中逐个随机选择，每次选择后将其与当前位置交换
-    // 这样可以保证：1) 每个学生被选中的概率相等  2) 不会重复选择  3) 时间复杂度 O(n)
-    for (int i = 0; i < number; i++)
+    Metrics::Add(Counter::StateLoads);
+    session.Interrupt();
+    Metrics::Set(Gauge::HistorySize, engine.HistorySize());
+    Metrics::Set(Gauge::UndoDepth, engine.UndoDepth());
+    return 0;
+}
+
+// 给名为 nameW 的学生加 points 分（可为负），成功返回 0，尚未导入名单或查无此人返回 -1
+EXPORT_DLL int AwardScore(const wchar_t* nameW, const int points)
+{
+    string name = nameW ? WideToUtf8(nameW) : string();
+    lock_guard<mutex> lock(randomMutex); // 线程安全保护
+    int index = engine.IsInitialized() ? engine.Find(name) : -1;
+    if (index < 0)
+        return -1;
+    int32_t total = engine.AddScore(index, points);
+    Metrics::Add(Counter::ScoresAwarded);
+    IC_LOG(LogLevel::Info, LogEvent::ScoreAwarded, index, points, total);
+    return 0;
+}
+
+// 积分榜：count 为正时取积分最高的 count 人，为负时取最低的 -count 人；
+// 每项为“姓名:积分”，按名次以两个空格分隔，同分时名单中靠前者在前
+EXPORT_DLL BSTR ScoreBoard(const int count)
+{
+    lock_guard<mutex> lock(randomMutex); // 线程安全保护
+    vector<int> ranked;
+    engine.Ranking(count < 0 ? -static_cast<size_t>(count) : static_cast<size_t>(count), count > 0, ranked);
+    string output;
+    for (int index : ranked)
+        output += (output.empty() ? "" : "  ") + engine.Name(index) + ":" + to_string(engine.Score(index));
+    return Platform::AllocString(output);
+}
+
+// 全部积分清零（如新学期开始时）
+EXPORT_DLL void ClearScores()
+{
+    lock_guard<mutex> lock(randomMutex); // 线程安全保护
+    engine.ClearScores();
+}
+
+// 最近 rounds 轮内（含本轮）被抽中过的学生，以两个空格分隔
+EXPORT_DLL BSTR RecentlyDrawn(const int rounds)
+{
+    lock_guard<mutex> lock(randomMutex); // 线程安全保护
+    string output;
+    for (size_t i = 0; rounds > 0 && i < engine.Size(); i++)
     {
-        // 从 [i, availableIndices.size()-1] 范围内随机选择一个位置
-        uniform_int_distribution<> dist(i, static_cast<int>(availableIndices.size()) - 1);
-        int randomPos = dist(gen);
-        
-        // 交换当前位置和随机位置的元素
-        swap(availableIndices[i], availableIndices[randomPos]);
-        
-        // 获取被选中的学生
-        string selectedStudent = students[availableIndices[i]];
-        
-        // 添加到输出
-        output += selectedStudent;
-        
-        // 标记该学生已被抽取
-        RandomHashSet.insert(selectedStudent);
-        
-        // 添加分隔符（除了最后一个学生）
-        if (i < number - 1)
-        {
-            output += "  ";
-        }
+        if (!engine.DrawnWithin(static_cast<int>(i), static_cast<uint32_t>(rounds))) continue;
+        if (!output.empty()) output += "  ";
+        output += engine.Name(static_cast<int>(i));
     }
-    
-    return SysAllocString(converter.from_bytes(output).c_str());
-}
\ No newline at end of file
+    return Platform::AllocString(output);
+}
+
+//点名器函数
+EXPORT_DLL BSTR SimpleRandom(const int number)
+{
+    string output;
+    DrawStatus status = DrawNames(number, output);
+    return Platform::AllocString(status == DrawStatus::Ok ? output : DrawStatusMessage(status));
+}
+
+// 分层点名：mode 为 0 时每组抽一人（忽略 number），为 1 时共抽 number 人并按各组剩余人数成比例分配
+// 姓名按组的先后以两个空格分隔；未分组导入的名单视为只有一组
+EXPORT_DLL BSTR StratifiedRandom(const int mode, const int number)
+{
+    string output;
+    DrawStatus status = DrawStratifiedNames(mode == 0 ? StratifyMode::OnePerGroup : StratifyMode::Proportional, number, output);
+    return Platform::AllocString(status == DrawStatus::Ok ? output : DrawStatusMessage(status));
+}
+
+// 按座位点名：mode 为 0 时抽 number 名两两不相邻的学生，为 1 时抽一人及其周围的同学（忽略 number，中心在前）
+EXPORT_DLL BSTR SpatialRandom(const int mode, const int number)
+{
+    string output;
+    DrawStatus status = DrawSpatialNames(mode == 0 ? SpatialMode::NonAdjacent : SpatialMode::Cluster, number, output);
+    return Platform::AllocString(status == DrawStatus::Ok ? output : DrawStatusMessage(status));
+}
+
+// 可验证抽取（见 VerifiableSession.h）：以当前名单开始一节课的会话，返回承诺值（十六进制），应在抽取前公布；
+// 尚未导入名单或系统熵源不可用时返回空串。已有会话时丢弃其记录重新开始。冷却与撤销记录保留
+EXPORT_DLL BSTR BeginVerifiableSession()
+{
+    array<uint8_t, 32> seed;
+    if (!Entropy::Fill(seed.data(), seed.size()))
+        return Platform::AllocString("");
+    lock_guard<mutex> lock(randomMutex); // 线程安全保护
+    string commitment = engine.IsInitialized() ? session.Begin(engine, seed) : string();
+    seed.fill(0);
+    Metrics::Set(Gauge::UndoDepth, engine.UndoDepth());
+    return Platform::AllocString(commitment);
+}
+
+// 结束会话并返回记录文本（含种子），用 iccore verify 与同一份名单即可离线核对；没有会话时返回空串
+EXPORT_DLL BSTR EndVerifiableSession()
+{
+    lock_guard<mutex> lock(randomMutex); // 线程安全保护
+    return Platform::AllocString(session.Reveal());
+}
@@ -0,0 +1,1200 @@
+#include "pch.h"
+#include "RandomEngine.h"
+#include "RosterParser.h"
+#include "Encoding.h"
+#include "Trace.h"
+#include "Metrics.h"
+#include <array>
+#include <bit>
+#include <charconv>
+#include <numeric>
+#include <unordered_map>
+using namespace std;
+
+/*
+ * 随机选择算法改进说明：
+ *
+ * 问题1：随机数生成器种子固定
+ * 原实现：使用全局的 random_device 和 mt19937，只在 DLL 加载时初始化一次
+ * 改进：最初改为每次调用 SimpleRandom 时重新创建 random_device 和 mt19937，代价过高，已由问题7 取代：
+ *       随机数流只在进程内用系统熵源播种一次，之后各线程、各名单句柄从中分出子流
+ * 效果：每次启动的序列都不同，不会因为种子固定而产生可预测的序列
+ *
+ * 问题2：低效的重试机制
+ * 原实现：随机选择后如果发现重复，就递减计数器重新选择
+ * 缺点：当已抽取学生接近总数时，可能需要大量重试
+ * 改进：使用 Fisher-Yates 洗牌算法，预先构建可用学生列表
+ * 效果：时间复杂度从最坏 O(∞) 降低到 O(n)，保证性能稳定
+ *
+ * 问题3：缺乏线程安全
+ * 原实现：全局变量无保护，多线程访问会导致数据竞争
+ * 改进：使用 mutex 和 lock_guard 保护所有共享状态（由 Random.cpp 中的导出函数负责）
+ * 效果：支持多线程安全调用
+ *
+ * 问题4：每次抽一人也要构建整个可用列表
+ * 绝大多数调用都是 SimpleRandom(1)，但通用路径每次都要遍历名单、逐个查询历史，代价 O(n)
+ * 改进：k ≤ SMALL_DRAW_MAX 时按 k 实例化专用内核，直接在全体学生中均匀取下标，
+ *       落在已抽取的学生上就重抽；剩余人数不少于一半时期望重抽次数不超过 2
+ * 效果：常见的小 k 抽取与名单规模无关，剩余人数少时仍走通用路径
+ *
+ * 问题5：清空历史的代价随名单增长
+ * 原实现：已抽取历史是按姓名存储的 unordered_set，每节课切换时 clear() 要逐个释放节点，查询还要对姓名求哈希
+ * 改进：每名学生记录最近一次被抽中的轮次（lastDrawnEpoch），“本轮已抽中”即轮次等于当前轮次；
+ *       清空历史只需把当前轮次加一，查询是一次数组访问
+ * 效果：ClearHistory 为 O(1)，与名单规模无关；保留的轮次还能回答“最近 N 轮内是否抽中过”
+ *
+ * 问题6：新一轮的第一个人可能就是上一轮的最后一个人
+ * 原实现：一轮内不重复，但整轮抽完、历史清空后所有人立即恢复可选
+ * 改进：可选的冷却（SetCooldown）用环形缓冲区记下最近抽中的 N 人次，每名学生记录在缓冲区中出现的次数；
+ *       另外维护“冷却中且本轮未抽中”的人数，抽取时直接从可选人数中扣除，不必扫描缓冲区
+ * 效果：每抽中一人的冷却簿记为 O(1)；跨轮次也不会在 N 人次内重复抽到同一人
+ *
+ * 问题7：每次调用重新打开 random_device
+ * 原实现（问题1 的改进）：每次抽取都新建 random_device 和 mt19937，打开系统熵源的代价约 10 µs，远大于抽取本身；
+ *       多个名单句柄、多个线程也只能各自重新播种
+ * 改进：xoshiro256** 随机数流（Rng.h），主流只在进程内播种一次，用跳跃函数分出互不重叠的子流；
+ *       每个线程、每个名单句柄各持有一条流，抽取时不共享生成器
+ * 效果：默认路径不再访问系统熵源；各条流之间互不相关，也不会因为种子相同而重复
+ */
+
+static constexpr int SMALL_DRAW_MAX = 4;
+
+// 解析座位行号、列号，不是整数时返回 Seat::NONE
+static int ParseCoordinate(const string& text)
+{
+    int value;
+    auto result = from_chars(text.data(), text.data() + text.size(), value);
+    if (result.ec != errc() || result.ptr != text.data() + text.size() || value == Seat::NONE)
+        return Seat::NONE;
+    return value;
+}
+
+int RandomEngine::Import(const string& filePath, const RosterColumns& columns)
+{
+    // 导入失败时不保留旧名单的任何状态（含分组），载入空名单即全部清空并标记为未导入
+    ifstream file(filePath, ios::binary);
+    if (!file) {
+        Load({});
+        string filename = filePath.substr(filePath.find_last_of("\\/") + 1);
+        Platform::ShowError(L"IslandCaller: Failed to open: " + Utf8ToWide(filename));
+        return -1;
+    }
+    // 一次读入整个文件，再按行解析（见 RosterParser.cpp）
+    string data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    file.close();
+
+    // 只读取指定了标题的附加列，座位的行列需同时指定
+    vector<string> headers;
+    for (const string* column : { &columns.group, &columns.row, &columns.column })
+    {
+        if (!column->empty()) headers.push_back(*column);
+    }
+    bool hasSeats = !columns.row.empty() && !columns.column.empty();
+    vector<string> names, ids;
+    vector<vector<string>> values;
+    {
+        IC_TRACE_SPAN(TraceOp::Parse);
+        if (headers.empty() && !columns.ids)
+            ParseRoster(data, names);
+        else if (!ParseRoster(data, names, headers, values, columns.ids ? &ids : nullptr)) {
+            Load({});
+            Platform::ShowError(L"IslandCaller: Column not found!");
+            return -1;
+        }
+    }
+    Metrics::Add(Counter::BytesParsed, data.size());
+    Metrics::Add(Counter::RowsParsed, names.size());
+
+    vector<string> groups = columns.group.empty() ? vector<string>() : move(values[0]);
+    vector<Seat> seats;
+    if (hasSeats)
+    {
+        const vector<string>& rows = values[values.size() - 2];
+        const vector<string>& cols = values[values.size() - 1];
+        seats.resize(names.size());
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            seats[i].row = ParseCoordinate(rows[i]);
+            seats[i].column = ParseCoordinate(cols[i]);
+        }
+    }
+    int result = Load(names, groups, seats, ids);
+    if (result == -2) {
+        Platform::ShowError(L"IslandCaller: Seating chart is too sparse!");
+        return -1;
+    }
+    if (result != 0) {
+        // 检查名单是否为空
+        Platform::ShowError(L"IslandCaller: Namelist is empty!");
+        return -1;
+    }
+    return 0;
+}
+
+int RandomEngine::Load(const vector<string>& names, const vector<string>& groups, const vector<Seat>& seats,
+    const vector<string>& ids)
+{
+    students.clear();
+    this->ids.clear();
+    groupNames.clear();
+    groupOf.clear();
+    nameIndex.clear();
+
+    // 导入时去重：按 (姓名哈希, 原下标) 排序，哈希相同的一段内逐个比较，同名者只保留最先出现的；
+    // 不为每个姓名分配哈希表节点，排好的结果直接作为 Find 的索引
+    vector<pair<size_t, int>> order;
+    order.reserve(names.size());
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        if (!names[i].empty()) order.emplace_back(hash<string_view>()(names[i]), static_cast<int>(i));
+    }
+    sort(order.begin(), order.end());
+    vector<uint8_t> keep(names.size(), 0);
+    for (size_t run = 0; run < order.size();)
+    {
+        size_t end = run + 1;
+        while (end < order.size() && order[end].first == order[run].first) end++;
+        for (size_t x = run; x < end; x++)
+        {
+            bool duplicate = false;
+            for (size_t y = run; y < x && !duplicate; y++)
+                duplicate = keep[order[y].second] && names[order[y].second] == names[order[x].second];
+            keep[order[x].second] = !duplicate;
+        }
+        run = end;
+    }
+
+    vector<int> newIndex(names.size(), -1);
+    unordered_map<string_view, int> groupIds;
+    vector<Seat> studentSeats;
+    if (groups.empty())
+        groupNames.emplace_back();
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        if (!keep[i]) continue;
+        newIndex[i] = static_cast<int>(students.size());
+        students.push_back(names[i]);
+        if (!ids.empty()) this->ids.push_back(ids[i]);
+        if (!seats.empty()) studentSeats.push_back(seats[i]);
+        if (groups.empty())
+        {
+            groupOf.push_back(0);
+            continue;
+        }
+        auto found = groupIds.try_emplace(groups[i], static_cast<int>(groupNames.size())).first;
+        if (found->second == static_cast<int>(groupNames.size()))
+            groupNames.emplace_back(groups[i]);
+        groupOf.push_back(found->second);
+    }
+    // 保留下来的学生新下标随原下标递增，替换后 order 仍按 (哈希, 下标) 有序
+    nameIndex.reserve(students.size());
+    for (const auto& [h, i] : order)
+    {
+        if (keep[i]) nameIndex.emplace_back(h, newIndex[i]);
+    }
+    if (students.empty())
+        groupNames.clear();
+
+    // 按组计数排序（稳定），每组的学生在 groupMembers 中占一段连续区间
+    groupStart.assign(groupNames.size() + 1, 0);
+    for (int group : groupOf)
+        groupStart[group + 1]++;
+    for (size_t g = 0; g < groupNames.size(); g++)
+        groupStart[g + 1] += groupStart[g];
+    groupMembers.resize(students.size());
+    vector<int> next(groupStart.begin(), groupStart.end() - 1);
+    for (size_t i = 0; i < students.size(); i++)
+        groupMembers[next[groupOf[i]]++] = static_cast<int>(i);
+
+    // 座位表：行列去掉公共偏移后放进外接矩形大小的网格，同一座位上有多人时只保留第一人
+    seatGrid.clear();
+    seated.clear();
+    seatCell.assign(students.size(), -1);
+    blockedStamp.assign(students.size(), 0);
+    blockStamp = 0;
+    gridRows = gridColumns = 0;
+    int rowMax = INT32_MIN, colMax = INT32_MIN;
+    gridRowMin = gridColumnMin = INT32_MAX;
+    for (const Seat& seat : studentSeats)
+    {
+        if (seat.row == Seat::NONE || seat.column == Seat::NONE) continue;
+        gridRowMin = min(gridRowMin, seat.row);
+        gridColumnMin = min(gridColumnMin, seat.column);
+        rowMax = max(rowMax, seat.row);
+        colMax = max(colMax, seat.column);
+    }
+    if (rowMax != INT32_MIN)
+    {
+        // 网格过大（多半是行列号填错）时拒绝导入，避免按坐标分配巨大的数组
+        int64_t rows = static_cast<int64_t>(rowMax) - gridRowMin + 1;
+        int64_t cols = static_cast<int64_t>(colMax) - gridColumnMin + 1;
+        if (rows * cols > 4 * static_cast<int64_t>(students.size()) + 4096)
+        {
+            Load({}); // 连同分组与座位表一起清空
+            return -2;
+        }
+        gridRows = static_cast<int>(rows);
+        gridColumns = static_cast<int>(cols);
+        seatGrid.assign(static_cast<size_t>(rows * cols), -1);
+        for (size_t i = 0; i < studentSeats.size(); i++)
+        {
+            const Seat& seat = studentSeats[i];
+            if (seat.row == Seat::NONE || seat.column == Seat::NONE) continue;
+            int cell = (seat.row - gridRowMin) * gridColumns + (seat.column - gridColumnMin);
+            if (seatGrid[cell] != -1) continue;
+            seatGrid[cell] = static_cast<int>(i);
+            seatCell[i] = cell;
+            seated.push_back(static_cast<int>(i));
+        }
+    }
+
+    // 名单指纹：FNV-1a 依次哈希每名学生的姓名、所在组名与座位格子
+    rosterHash = 14695981039346656037ull;
+    auto hashBytes = [&](const void* data, size_t size) {
+        for (size_t i = 0; i < size; i++)
+            rosterHash = (rosterHash ^ static_cast<const uint8_t*>(data)[i]) * 1099511628211ull;
+    };
+    for (size_t i = 0; i < students.size(); i++)
+    {
+        const string& group = groupNames[groupOf[i]];
+        hashBytes(students[i].data(), students[i].size() + 1);
+        hashBytes(group.data(), group.size() + 1);
+        hashBytes(&seatCell[i], sizeof(int));
+    }
+
+    // 新名单的下标与旧名单无关，历史一并重置
+    lastDrawnEpoch.assign(students.size(), 0);
+    groupEpoch.assign(groupNames.size(), 0);
+    groupDrawn.assign(groupNames.size(), 0);
+    epoch = 1;
+    drawnCount = 0;
+    ResetUndo();
+    scores.Reset(students.size());
+    coolingCount.assign(students.size(), 0);
+    fill(recentPicks.begin(), recentPicks.end(), -1);
+    recentHead = coolingStudents = coolingAvailable = 0;
+    ClearExclusions();
+    isInitialized = !students.empty();
+    if (!isInitialized)
+        return -1;
+    return 0;
+}
+
+void RandomEngine::ClearHistory()
+{
+    RecordScope record(*this);
+    NextEpoch(); // 清空已抽取的学生名单
+}
+
+void RandomEngine::NextEpoch()
+{
+    drawnCount = 0;
+    coolingAvailable = coolingStudents; // 新一轮中冷却的学生都还未抽中
+    if (++epoch == 0)
+    {
+        // 轮次用尽（约 42 亿次清空）时回绕，旧的轮次记录失效，撤销记录也随之作废
+        fill(lastDrawnEpoch.begin(), lastDrawnEpoch.end(), 0);
+        fill(groupEpoch.begin(), groupEpoch.end(), 0);
+        epoch = 1;
+        ResetUndo();
+    }
+}
+
+void RandomEngine::SetCooldown(size_t picks)
+{
+    recentPicks.assign(picks, -1);
+    recentHead = 0;
+    coolingCount.assign(students.size(), 0);
+    coolingStudents = coolingAvailable = 0;
+    ResetUndo(); // 撤销记录中保存的被挤出者对应旧的缓冲区
+}
+
+int RandomEngine::CoolDown(int index)
+{
+    // index 即将被标记为本轮已抽中：原本就在冷却中的话不再计入“冷却中且未抽中”
+    if (coolingCount[index]++ == 0) coolingStudents++;
+    else coolingAvailable--;
+    int evicted = recentPicks[recentHead];
+    recentPicks[recentHead] = index;
+    recentHead = (recentHead + 1) % recentPicks.size();
+    if (evicted >= 0 && --coolingCount[evicted] == 0)
+    {
+        coolingStudents--;
+        if (evicted != index && !IsDrawn(evicted)) coolingAvailable--;
+    }
+    if (recording) pending.marks.back().evicted = evicted;
+    return evicted;
+}
+
+// 撤销、重做后按缓冲区重新统计冷却人数，O(N log N)
+void RandomEngine::CountCooling()
+{
+    vector<int> cooling;
+    for (int index : recentPicks)
+        if (index >= 0) cooling.push_back(index);
+    sort(cooling.begin(), cooling.end());
+    cooling.erase(unique(cooling.begin(), cooling.end()), cooling.end());
+    coolingStudents = cooling.size();
+    coolingAvailable = count_if(cooling.begin(), cooling.end(), [&](int index) { return !IsDrawn(index); });
+}
+
+RandomEngine::RecordScope::RecordScope(RandomEngine& engine) : engine(engine)
+{
+    engine.pending.marks.clear();
+    engine.pending.epochBefore = engine.epoch;
+    engine.pending.drawnBefore = engine.drawnCount;
+    engine.recording = true;
+}
+
+RandomEngine::RecordScope::~RecordScope()
+{
+    RandomEngine& e = engine;
+    if (!e.recording)
+        return;
+    e.recording = false;
+    if (e.pending.marks.empty() && e.epoch == e.pending.epochBefore)
+        return; // 没有改动历史（抽 0 人或抽取失败），不影响已有的重做记录
+    e.pending.epochAfter = e.epoch;
+    e.pending.drawnAfter = e.drawnCount;
+    swap(e.undoRing[e.undoHead], e.pending);
+    e.undoHead = (e.undoHead + 1) % UNDO_LIMIT;
+    e.undoCount = min(e.undoCount + 1, UNDO_LIMIT);
+    e.redoCount = 0;
+}
+
+// 逆序恢复每个标记的旧值，再恢复轮次与人数；自动或手动清空只需把轮次改回去，上一轮的标记原样保留在 lastDrawnEpoch 中
+bool RandomEngine::Undo(vector<int>& reverted)
+{
+    reverted.clear();
+    if (undoCount == 0)
+        return false;
+    undoHead = (undoHead + UNDO_LIMIT - 1) % UNDO_LIMIT;
+    const DrawRecord& record = undoRing[undoHead];
+    for (auto mark = record.marks.rbegin(); mark != record.marks.rend(); ++mark)
+    {
+        int g = groupOf[mark->index];
+        lastDrawnEpoch[mark->index] = mark->lastEpoch;
+        groupEpoch[g] = mark->groupEpoch;
+        groupDrawn[g] = mark->groupDrawn;
+        reverted.push_back(mark->index);
+        if (!recentPicks.empty())
+        {
+            // 冷却缓冲区退回一格，放回被挤出的学生
+            recentHead = (recentHead + recentPicks.size() - 1) % recentPicks.size();
+            coolingCount[recentPicks[recentHead]]--;
+            recentPicks[recentHead] = mark->evicted;
+            if (mark->evicted >= 0) coolingCount[mark->evicted]++;
+        }
+    }
+    reverse(reverted.begin(), reverted.end());
+    epoch = record.epochBefore;
+    drawnCount = record.drawnBefore;
+    if (!recentPicks.empty()) CountCooling();
+    undoCount--;
+    redoCount++;
+    return true;
+}
+
+bool RandomEngine::Redo(vector<int>& reapplied)
+{
+    reapplied.clear();
+    if (redoCount == 0)
+        return false;
+    const DrawRecord& record = undoRing[undoHead];
+    epoch = record.epochAfter;
+    for (const DrawMark& mark : record.marks)
+    {
+        int g = groupOf[mark.index];
+        if (groupEpoch[g] != epoch)
+        {
+            groupEpoch[g] = epoch;
+            groupDrawn[g] = 0;
+        }
+        groupDrawn[g]++;
+        lastDrawnEpoch[mark.index] = epoch;
+        reapplied.push_back(mark.index);
+        if (!recentPicks.empty())
+        {
+            if (mark.evicted >= 0) coolingCount[mark.evicted]--;
+            recentPicks[recentHead] = mark.index;
+            coolingCount[mark.index]++;
+            recentHead = (recentHead + 1) % recentPicks.size();
+        }
+    }
+    drawnCount = record.drawnAfter;
+    if (!recentPicks.empty()) CountCooling();
+    undoHead = (undoHead + 1) % UNDO_LIMIT;
+    undoCount++;
+    redoCount--;
+    return true;
+}
+
+// ---------- 状态快照 ----------
+// 布局（小端）：
+//   "ICST" | 版本 u16 | 保留 u16 | 人数 u32 | 组数 u32 | 名单指纹 u64 | 轮次 u32 | 本轮已抽人数 u32
+//   | lastDrawnEpoch u32 × 人数 | groupEpoch u32 × 组数 | groupDrawn u32 × 组数 | 积分 i32 × 人数（版本 2 起）
+//   | 最近记录字节数 u32 | 最近记录（SaveRecent 的输出，版本 3 起）| CRC32 u32（覆盖之前的全部字节）
+
+static constexpr char STATE_MAGIC[4] = { 'I', 'C', 'S', 'T' };
+static constexpr size_t STATE_HEADER_SIZE = 32;
+
+// CRC32（IEEE）按 8 字节一组查表（slicing-by-8），比逐字节查表快数倍
+static const array<array<uint32_t, 256>, 8> CRC_TABLES = [] {
+    array<array<uint32_t, 256>, 8> tables{};
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++)
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        tables[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; i++)
+        for (int t = 1; t < 8; t++)
+            tables[t][i] = (tables[t - 1][i] >> 8) ^ tables[0][tables[t - 1][i] & 0xFF];
+    return tables;
+}();
+
+static uint32_t Crc32(const uint8_t* data, size_t size)
+{
+    uint32_t crc = 0xFFFFFFFFu;
+    for (; size >= 8; data += 8, size -= 8)
+    {
+        uint32_t low = crc ^ (data[0] | data[1] << 8 | data[2] << 16 | static_cast<uint32_t>(data[3]) << 24);
+        crc = CRC_TABLES[7][low & 0xFF] ^ CRC_TABLES[6][(low >> 8) & 0xFF] ^
+              CRC_TABLES[5][(low >> 16) & 0xFF] ^ CRC_TABLES[4][low >> 24] ^
+              CRC_TABLES[3][data[4]] ^ CRC_TABLES[2][data[5]] ^ CRC_TABLES[1][data[6]] ^ CRC_TABLES[0][data[7]];
+    }
+    for (; size > 0; data++, size--)
+        crc = CRC_TABLES[0][(crc ^ *data) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void PutLE(uint8_t* p, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+        p[i] = static_cast<uint8_t>(value >> (8 * i));
+}
+
+static uint64_t GetLE(const uint8_t* p, int bytes)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++)
+        value |= static_cast<uint64_t>(p[i]) << (8 * i);
+    return value;
+}
+
+// 小端机器上 32 位数组直接整块拷贝，否则逐个按小端编码
+template <class T>
+static void PutArray(uint8_t*& p, const vector<T>& values)
+{
+    static_assert(sizeof(T) == 4);
+    if constexpr (endian::native == endian::little)
+        memcpy(p, values.data(), values.size() * 4);
+    else
+        for (size_t i = 0; i < values.size(); i++)
+            PutLE(p + 4 * i, static_cast<uint32_t>(values[i]), 4);
+    p += values.size() * 4;
+}
+
+template <class T>
+static void GetArray(const uint8_t*& p, vector<T>& values)
+{
+    static_assert(sizeof(T) == 4);
+    if constexpr (endian::native == endian::little)
+        memcpy(values.data(), p, values.size() * 4);
+    else
+        for (size_t i = 0; i < values.size(); i++)
+            values[i] = static_cast<T>(static_cast<uint32_t>(GetLE(p + 4 * i, 4)));
+    p += values.size() * 4;
+}
+
+// 不含最近记录本身的快照大小
+static size_t StateSize(uint64_t version, uint64_t count, uint64_t groups)
+{
+    return STATE_HEADER_SIZE + 4 * (count + 2 * groups + (version >= 2 ? count : 0) + (version >= 3 ? 1 : 0)) + 4;
+}
+
+void RandomEngine::SaveState(string& out) const
+{
+    size_t count = lastDrawnEpoch.size(), groups = groupEpoch.size();
+    string recent;
+    SaveRecent(recent);
+    out.assign(StateSize(STATE_VERSION, count, groups) + recent.size(), '\0');
+    uint8_t* p = reinterpret_cast<uint8_t*>(out.data());
+    memcpy(p, STATE_MAGIC, 4);
+    PutLE(p + 4, STATE_VERSION, 2);
+    PutLE(p + 8, count, 4);
+    PutLE(p + 12, groups, 4);
+    PutLE(p + 16, rosterHash, 8);
+    PutLE(p + 24, epoch, 4);
+    PutLE(p + 28, drawnCount, 4);
+    p += STATE_HEADER_SIZE;
+    for (const vector<uint32_t>* values : { &lastDrawnEpoch, &groupEpoch, &groupDrawn })
+        PutArray(p, *values);
+    PutArray(p, scores.Values());
+    PutLE(p, recent.size(), 4);
+    memcpy(p + 4, recent.data(), recent.size());
+    p += 4 + recent.size();
+    PutLE(p, Crc32(reinterpret_cast<const uint8_t*>(out.data()), out.size() - 4), 4);
+}
+
+RandomEngine::StateError RandomEngine::LoadState(string_view data)
+{
+    if (!isInitialized)
+        return StateError::NotInitialized;
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data.data());
+    if (data.size() < STATE_HEADER_SIZE + 4 || memcmp(p, STATE_MAGIC, 4) != 0)
+        return StateError::Corrupted;
+    uint64_t version = GetLE(p + 4, 2);
+    uint64_t count = GetLE(p + 8, 4), groups = GetLE(p + 12, 4);
+    if (version == 0 || version > STATE_VERSION || count > data.size() || groups > data.size())
+        return StateError::Corrupted;
+    size_t size = StateSize(version, count, groups);
+    size_t recentSize = version >= 3 && data.size() >= size ? static_cast<size_t>(GetLE(p + size - 8, 4)) : 0;
+    if (data.size() < size || data.size() - size != recentSize || GetLE(p + data.size() - 4, 4) != Crc32(p, data.size() - 4))
+        return StateError::Corrupted;
+    if (count != students.size() || groups != groupNames.size() || GetLE(p + 16, 8) != rosterHash)
+        return StateError::RosterMismatch;
+
+    // 校验通过后才开始覆盖，恢复失败时原状态不变；LoadRecent 自身先检查后覆盖，放在最前
+    if (version >= 3 && !LoadRecent(data.substr(size - 4, recentSize)))
+        return StateError::Corrupted;
+    uint32_t savedEpoch = static_cast<uint32_t>(GetLE(p + 24, 4));
+    size_t savedDrawn = static_cast<size_t>(GetLE(p + 28, 4));
+    p += STATE_HEADER_SIZE;
+    for (vector<uint32_t>* values : { &lastDrawnEpoch, &groupEpoch, &groupDrawn })
+        GetArray(p, *values);
+    if (version >= 2)
+        GetArray(p, scores.Values());
+    else
+        fill(scores.Values().begin(), scores.Values().end(), 0);
+    scores.Rebuild();
+    epoch = savedEpoch == 0 ? 1 : savedEpoch;
+    drawnCount = min(savedDrawn, students.size());
+    // 旧版本的快照没有最近记录：保留当前的冷却记录，撤销记录中的旧值属于恢复前的历史，只能清空
+    if (version < 3)
+        ResetUndo();
+    CountCooling(); // 冷却中且本轮未抽中的人数随历史改变
+    return StateError::Ok;
+}
+
+// ---------- 最近记录 ----------
+// 布局（小端，每项 u32）：冷却人次 | 缓冲区从最早到最新的学生下标（-1 为空槽）| 可撤销条数 | 可重做条数
+//   | 从最早一条可撤销记录起的每条记录：轮次前后 | 人数前后 | 标记数 | 每个标记的学生、原轮次、组轮次、组人数、被挤出者
+
+void RandomEngine::SaveRecent(string& out) const
+{
+    out.clear();
+    auto put = [&](uint64_t value) {
+        uint8_t bytes[4];
+        PutLE(bytes, value, 4);
+        out.append(reinterpret_cast<const char*>(bytes), 4);
+    };
+    put(recentPicks.size());
+    for (size_t i = 0; i < recentPicks.size(); i++)
+        put(static_cast<uint32_t>(recentPicks[(recentHead + i) % recentPicks.size()]));
+    put(undoCount);
+    put(redoCount);
+    size_t first = (undoHead + UNDO_LIMIT - undoCount) % UNDO_LIMIT;
+    for (size_t r = 0; r < undoCount + redoCount; r++)
+    {
+        const DrawRecord& record = undoRing[(first + r) % UNDO_LIMIT];
+        for (uint64_t value : { uint64_t(record.epochBefore), uint64_t(record.epochAfter), uint64_t(record.drawnBefore),
+                                uint64_t(record.drawnAfter), uint64_t(record.marks.size()) })
+            put(value);
+        for (const DrawMark& mark : record.marks)
+            for (uint64_t value : { uint64_t(uint32_t(mark.index)), uint64_t(mark.lastEpoch), uint64_t(mark.groupEpoch),
+                                    uint64_t(mark.groupDrawn), uint64_t(uint32_t(mark.evicted)) })
+                put(value);
+    }
+}
+
+bool RandomEngine::LoadRecent(string_view data)
+{
+    if (!isInitialized || data.size() % 4 != 0)
+        return false;
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data.data());
+    size_t words = data.size() / 4, pos = 0;
+    uint64_t value = 0;
+    auto get = [&]() {
+        if (pos >= words) return false;
+        value = GetLE(p + 4 * pos++, 4);
+        return true;
+    };
+    // 读出一名学生的下标，emptyAllowed 时 -1 也有效
+    auto student = [&](int& index, bool emptyAllowed) {
+        if (!get()) return false;
+        index = static_cast<int32_t>(value);
+        return (emptyAllowed && index == -1) || (index >= 0 && static_cast<size_t>(index) < students.size());
+    };
+    auto count = [&](uint64_t limit, size_t& out) {
+        if (!get() || value > limit) return false;
+        out = static_cast<size_t>(value);
+        return true;
+    };
+
+    // 全部读出并检查后才开始覆盖
+    size_t cooldown, undo, redo;
+    if (!count(words, cooldown))
+        return false;
+    vector<int> ring(cooldown);
+    for (int& index : ring)
+        if (!student(index, true)) return false;
+    if (!count(UNDO_LIMIT, undo) || !count(UNDO_LIMIT - undo, redo))
+        return false;
+    vector<DrawRecord> records(undo + redo);
+    for (DrawRecord& record : records)
+    {
+        size_t marks;
+        if (!get() || value == 0) return false;
+        record.epochBefore = static_cast<uint32_t>(value);
+        if (!get() || value == 0) return false;
+        record.epochAfter = static_cast<uint32_t>(value);
+        if (!count(students.size(), record.drawnBefore) || !count(students.size(), record.drawnAfter) || !count(words, marks))
+            return false;
+        record.marks.resize(marks);
+        for (DrawMark& mark : record.marks)
+        {
+            size_t groupDrawn;
+            if (!student(mark.index, false) || !get()) return false;
+            mark.lastEpoch = static_cast<uint32_t>(value);
+            if (!get()) return false;
+            mark.groupEpoch = static_cast<uint32_t>(value);
+            if (!count(students.size(), groupDrawn) || !student(mark.evicted, true)) return false;
+            mark.groupDrawn = static_cast<uint32_t>(groupDrawn);
+        }
+    }
+    if (pos != words)
+        return false;
+
+    recentPicks = move(ring);
+    recentHead = 0;
+    coolingCount.assign(students.size(), 0);
+    for (int index : recentPicks)
+        if (index >= 0) coolingCount[index]++;
+    CountCooling();
+    for (size_t r = 0; r < records.size(); r++)
+        swap(undoRing[r], records[r]);
+    undoHead = undo % UNDO_LIMIT;
+    undoCount = undo;
+    redoCount = redo;
+    recording = false;
+    return true;
+}
+
+int RandomEngine::Find(string_view name) const
+{
+    if (nameIndex.size() != students.size())
+    {
+        nameIndex.resize(students.size());
+        for (size_t i = 0; i < students.size(); i++)
+            nameIndex[i] = { hash<string_view>()(students[i]), static_cast<int>(i) };
+        sort(nameIndex.begin(), nameIndex.end());
+    }
+    size_t h = hash<string_view>()(name);
+    for (auto it = lower_bound(nameIndex.begin(), nameIndex.end(), make_pair(h, INT32_MIN));
+         it != nameIndex.end() && it->first == h; ++it)
+    {
+        if (students[it->second] == name) return it->second;
+    }
+    return -1;
+}
+
+bool RandomEngine::DrawnWithin(int index, uint32_t rounds) const
+{
+    uint32_t last = lastDrawnEpoch[index];
+    return last != 0 && epoch - last < rounds;
+}
+
+DrawStatus RandomEngine::Draw(int number, vector<int>& picked)
+{
+    return Draw(number, picked, Rng::ThreadStream(randomMode));
+}
+
+// 每次接受的下标在剩余可选学生中均匀分布，与通用路径的 Fisher-Yates 结果分布相同
+template <int K>
+bool RandomEngine::DrawSmall(size_t available, bool cooling, vector<int>& picked, RandomStream& gen)
+{
+    if (available < K || (available - K) * 2 < students.size())
+        return false;
+
+    int chosen[K];
+    for (int i = 0; i < K; i++)
+    {
+        int candidate;
+        do
+        {
+            candidate = static_cast<int>(gen.Below(students.size()));
+        } while (IsDrawn(candidate) || (cooling && IsCooling(candidate)) || find(chosen, chosen + i, candidate) != chosen + i);
+        chosen[i] = candidate;
+    }
+    picked.assign(chosen, chosen + K);
+    for (int index : chosen)
+        MarkDrawn(index);
+    return true;
+}
+
+DrawStatus RandomEngine::Draw(int number, vector<int>& picked, RandomStream& gen)
+{
+    RecordScope record(*this);
+    picked.clear();
+    if (!isInitialized)
+    {
+        return DrawStatus::NotInitialized;
+    }
+    if (number < 0 || number > static_cast<int>(students.size()))
+    {
+        return DrawStatus::NotEnoughStudents; // 如果请求的数量超过学生名单，则退出
+    }
+
+    // 如果已抽取的学生数量等于或超过总学生数，清空历史记录
+    if (drawnCount >= students.size())
+    {
+        NextEpoch();
+    }
+
+    // 冷却中且本轮未抽中的学生不可选；遵守冷却会导致人数不足时本次忽略冷却
+    size_t available = students.size() - drawnCount;
+    bool cooling = coolingAvailable > 0 && available - coolingAvailable >= static_cast<size_t>(number);
+    if (cooling) available -= coolingAvailable;
+
+    if (exclusionPairs > 0 && number >= 2)
+        return DrawExclusive(number, cooling, picked, gen);
+
+    // 小 k 按编译期常量分派到专用内核
+    bool done = false;
+    switch (number)
+    {
+    case 1: done = DrawSmall<1>(available, cooling, picked, gen); break;
+    case 2: done = DrawSmall<2>(available, cooling, picked, gen); break;
+    case 3: done = DrawSmall<3>(available, cooling, picked, gen); break;
+    case SMALL_DRAW_MAX: done = DrawSmall<SMALL_DRAW_MAX>(available, cooling, picked, gen); break;
+    }
+    if (done)
+        return DrawStatus::Ok;
+
+    // 创建可用学生索引列表（未被抽取的学生）
+    vector<int> availableIndices;
+    availableIndices.reserve(available);
+    for (size_t i = 0; i < students.size(); i++)
+    {
+        if (!IsDrawn(static_cast<int>(i)) && !(cooling && IsCooling(static_cast<int>(i))))
+        {
+            availableIndices.push_back(static_cast<int>(i));
+        }
+    }
+
+    // 验证有足够的可用学生
+    // 注意：此检查是必要的，因为在清空历史后，
+    // availableIndices 会包含所有学生，仍需确保数量足够
+    if (number > static_cast<int>(availableIndices.size()))
+    {
+        return DrawStatus::NotEnoughAvailable;
+    }
+
+    // 使用 Fisher-Yates 洗牌算法随机选择学生
+    // 算法原理：从可用学生中逐个随机选择，每次选择后将其与当前位置交换
+    // 这样可以保证：1) 每个学生被选中的概率相等  2) 不会重复选择  3) 时间复杂度 O(n)
+    for (int i = 0; i < number; i++)
+    {
+        // 从 [i, availableIndices.size()-1] 范围内随机选择一个位置
+        int randomPos = gen.Between(i, static_cast<int>(availableIndices.size()) - 1);
+
+        // 交换当前位置和随机位置的元素
+        swap(availableIndices[i], availableIndices[randomPos]);
+
+        // 标记该学生已被抽取
+        picked.push_back(availableIndices[i]);
+        MarkDrawn(availableIndices[i]);
+    }
+    return DrawStatus::Ok;
+}
+
+bool RandomEngine::AddExclusion(int a, int b)
+{
+    int n = static_cast<int>(students.size());
+    if (a < 0 || b < 0 || a >= n || b >= n || a == b)
+        return false;
+    if (Excluded(a, b))
+        return true;
+    for (int index : { a, b })
+    {
+        if (exclusionRow[index] >= 0) continue;
+        exclusionRow[index] = static_cast<int>(exclusionBits.size() / exclusionWords);
+        exclusionBits.resize(exclusionBits.size() + exclusionWords, 0);
+    }
+    exclusionBits[exclusionRow[a] * exclusionWords + b / 64] |= 1ull << (b % 64);
+    exclusionBits[exclusionRow[b] * exclusionWords + a / 64] |= 1ull << (a % 64);
+    exclusionPairs++;
+    return true;
+}
+
+void RandomEngine::ClearExclusions()
+{
+    exclusionRow.assign(students.size(), -1);
+    exclusionBits.clear();
+    exclusionWords = (students.size() + 63) / 64;
+    exclusionPairs = 0;
+}
+
+void RandomEngine::Exclusions(vector<pair<int, int>>& pairs) const
+{
+    pairs.clear();
+    for (size_t a = 0; a < exclusionRow.size(); a++)
+    {
+        int row = exclusionRow[a];
+        for (size_t b = a + 1; row >= 0 && b < students.size(); b++)
+            if (exclusionBits[row * exclusionWords + b / 64] >> (b % 64) & 1)
+                pairs.emplace_back(static_cast<int>(a), static_cast<int>(b));
+    }
+}
+
+DrawStatus RandomEngine::DrawExclusive(int number, bool cooling, vector<int>& picked, RandomStream& gen)
+{
+    vector<uint64_t>& masks = exclusionMasks;
+    masks.resize((number + 1) * exclusionWords);
+    // 第 0 行：可选的学生；newRound 为 true 时按新一轮计算（本轮已抽中的也可选）
+    // 逐位拼接而不分支：轮次中途已抽中与未抽中的学生交错，分支预测几乎总是失败
+    auto fillCandidates = [&](bool newRound, bool cooling) {
+        bool excludeDrawn = !newRound;
+        uint32_t coolingMask = cooling ? UINT32_MAX : 0;
+        size_t count = 0;
+        for (size_t w = 0; w < exclusionWords; w++)
+        {
+            uint64_t bits = 0;
+            size_t end = min(students.size(), (w + 1) * 64);
+            for (size_t i = w * 64; i < end; i++)
+            {
+                bool candidate = !((lastDrawnEpoch[i] == epoch) & excludeDrawn) & ((coolingCount[i] & coolingMask) == 0);
+                bits |= static_cast<uint64_t>(candidate) << (i % 64);
+            }
+            masks[w] = bits;
+            count += popcount(bits);
+        }
+        return count;
+    };
+    if (fillCandidates(false, cooling) < static_cast<size_t>(number))
+        return DrawStatus::NotEnoughAvailable;
+    vector<int>& chosen = picked;
+    auto search = [&](bool newRound, bool cooling) {
+        fillCandidates(newRound, cooling);
+        chosen.clear();
+        return SearchExclusive(0, number, masks, chosen, gen);
+    };
+    // 遵守冷却凑不出组合时先在本轮忽略冷却重找
+    if (!SearchExclusive(0, number, masks, chosen, gen) && !(cooling && search(false, false)))
+    {
+        // 本轮剩下的学生凑不出满足约束的组合：视为本轮已结束，在新一轮的全体学生中重找（同样先遵守冷却），找到后才清空历史
+        if (drawnCount == 0)
+            return DrawStatus::ExclusionConflict;
+        bool newCooling = coolingStudents > 0 && students.size() - coolingStudents >= static_cast<size_t>(number);
+        if (!search(true, newCooling) && !(newCooling && search(true, false)))
+            return DrawStatus::ExclusionConflict;
+        NextEpoch();
+    }
+    for (int index : chosen)
+        MarkDrawn(index);
+    return DrawStatus::Ok;
+}
+
+// 在第 depth 行的候选中均匀取一人，下一行为去掉他与他的互斥对象后的候选；
+// 取到的人凑不齐时从本行删去再取下一人（之后的兄弟分支也不再考虑他），因此按组合而不是排列搜索，
+// 候选不足剩余人数时剪枝。没有走入死路时就是逐人屏蔽的顺序抽取，不回溯
+bool RandomEngine::SearchExclusive(int depth, int number, vector<uint64_t>& masks, vector<int>& chosen, RandomStream& gen)
+{
+    if (depth == number)
+        return true;
+    size_t words = exclusionWords;
+    uint64_t* mask = masks.data() + depth * words;
+    uint64_t* next = mask + words;
+    size_t candidates = 0;
+    for (size_t w = 0; w < words; w++)
+        candidates += popcount(mask[w]);
+    while (candidates >= static_cast<size_t>(number - depth))
+    {
+        // 取第 r 个候选：先按字跳过，再在字内逐个清除低位
+        size_t r = static_cast<size_t>(gen.Below(candidates));
+        size_t w = 0;
+        for (; static_cast<size_t>(popcount(mask[w])) <= r; w++)
+            r -= popcount(mask[w]);
+        uint64_t bits = mask[w];
+        for (; r > 0; r--)
+            bits &= bits - 1;
+        int index = static_cast<int>(w * 64 + countr_zero(bits));
+        mask[w] &= ~(1ull << (index % 64));
+        candidates--;
+
+        int row = exclusionRow[index];
+        for (size_t i = 0; i < words; i++)
+            next[i] = row >= 0 ? mask[i] & ~exclusionBits[row * words + i] : mask[i];
+        chosen.push_back(index);
+        if (SearchExclusive(depth + 1, number, masks, chosen, gen))
+            return true;
+        chosen.pop_back();
+    }
+    return false;
+}
+
+DrawStatus RandomEngine::DrawStratified(StratifyMode mode, int number, vector<int>& picked)
+{
+    return DrawStratified(mode, number, picked, Rng::ThreadStream(randomMode));
+}
+
+// 与小 k 内核相同：组内剩余人数不少于一半时在组的下标区间内拒绝采样，否则只收集本组的剩余学生做部分 Fisher-Yates
+// 每组的代价只与抽取人数或该组人数有关，每组抽一人的总代价不超过同样次数的单人抽取
+void RandomEngine::DrawFromGroup(int group, int count, vector<int>& picked, RandomStream& gen)
+{
+    if (count <= 0)
+        return;
+    int begin = groupStart[group];
+    int size = groupStart[group + 1] - begin;
+    size_t available = GroupAvailable(group);
+    if ((available - count) * 2 >= static_cast<size_t>(size))
+    {
+        for (int i = 0; i < count; i++)
+        {
+            int candidate;
+            do
+            {
+                candidate = groupMembers[gen.Between(begin, begin + size - 1)];
+            } while (IsDrawn(candidate));
+            picked.push_back(candidate);
+            MarkDrawn(candidate);
+        }
+        return;
+    }
+
+    vector<int> availableIndices;
+    availableIndices.reserve(available);
+    for (int i = begin; i < begin + size; i++)
+    {
+        if (!IsDrawn(groupMembers[i]))
+            availableIndices.push_back(groupMembers[i]);
+    }
+    for (int i = 0; i < count; i++)
+    {
+        swap(availableIndices[i], availableIndices[gen.Between(i, static_cast<int>(availableIndices.size()) - 1)]);
+        picked.push_back(availableIndices[i]);
+        MarkDrawn(availableIndices[i]);
+    }
+}
+
+DrawStatus RandomEngine::DrawStratified(StratifyMode mode, int number, vector<int>& picked, RandomStream& gen)
+{
+    RecordScope record(*this);
+    picked.clear();
+    if (!isInitialized)
+    {
+        return DrawStatus::NotInitialized;
+    }
+    if (drawnCount >= students.size())
+    {
+        NextEpoch();
+    }
+    int groups = static_cast<int>(groupNames.size());
+
+    if (mode == StratifyMode::OnePerGroup)
+    {
+        for (int g = 0; g < groups; g++)
+        {
+            if (GroupAvailable(g) > 0)
+            {
+                DrawFromGroup(g, 1, picked, gen);
+                continue;
+            }
+            // 本组本轮已全部抽过：在全组中抽一人，不计入历史
+            picked.push_back(groupMembers[gen.Between(groupStart[g], groupStart[g + 1] - 1)]);
+        }
+        return DrawStatus::Ok;
+    }
+
+    if (number < 0 || number > static_cast<int>(students.size()))
+    {
+        return DrawStatus::NotEnoughStudents;
+    }
+    size_t available = students.size() - drawnCount;
+    if (static_cast<size_t>(number) > available)
+    {
+        return DrawStatus::NotEnoughAvailable;
+    }
+
+    // 最大余数法：先按 number * 剩余人数 / 总剩余人数 取整分配，余下的名额给余数最大的组（余数相同时随机）
+    // 余数为正的组取整后的名额必然小于其剩余人数，因此补一个名额后仍不会超出
+    vector<int> quota(groups);
+    vector<uint64_t> remainder(groups);
+    int assigned = 0;
+    for (int g = 0; g < groups; g++)
+    {
+        uint64_t share = static_cast<uint64_t>(number) * GroupAvailable(g);
+        quota[g] = static_cast<int>(share / available);
+        remainder[g] = share % available;
+        assigned += quota[g];
+    }
+    if (assigned < number)
+    {
+        vector<int> order(groups);
+        iota(order.begin(), order.end(), 0);
+        gen.Shuffle(order.begin(), order.end());
+        stable_sort(order.begin(), order.end(), [&](int a, int b) { return remainder[a] > remainder[b]; });
+        for (int i = 0; assigned < number; i++, assigned++)
+            quota[order[i]]++;
+    }
+    for (int g = 0; g < groups; g++)
+        DrawFromGroup(g, quota[g], picked, gen);
+    return DrawStatus::Ok;
+}
+
+Seat RandomEngine::SeatOf(int index) const
+{
+    int cell = seatCell[index];
+    if (cell < 0)
+        return Seat();
+    return { gridRowMin + cell / gridColumns, gridColumnMin + cell % gridColumns };
+}
+
+bool RandomEngine::Adjacent(int a, int b) const
+{
+    if (a == b || seatCell[a] < 0 || seatCell[b] < 0)
+        return false;
+    int rowDiff = seatCell[a] / gridColumns - seatCell[b] / gridColumns;
+    int colDiff = seatCell[a] % gridColumns - seatCell[b] % gridColumns;
+    return abs(rowDiff) <= 1 && abs(colDiff) <= 1;
+}
+
+template <class Visit>
+void RandomEngine::ForEachNeighbour(int index, Visit visit) const
+{
+    int cell = seatCell[index];
+    if (cell < 0)
+        return;
+    int row = cell / gridColumns, col = cell % gridColumns;
+    for (int r = max(row - 1, 0); r <= min(row + 1, gridRows - 1); r++)
+    {
+        for (int c = max(col - 1, 0); c <= min(col + 1, gridColumns - 1); c++)
+        {
+            int neighbour = seatGrid[r * gridColumns + c];
+            if (neighbour >= 0 && neighbour != index)
+                visit(neighbour);
+        }
+    }
+}
+
+DrawStatus RandomEngine::DrawSpatial(SpatialMode mode, int number, vector<int>& picked)
+{
+    return DrawSpatial(mode, number, picked, Rng::ThreadStream(randomMode));
+}
+
+DrawStatus RandomEngine::DrawSpatial(SpatialMode mode, int number, vector<int>& picked, RandomStream& gen)
+{
+    RecordScope record(*this);
+    picked.clear();
+    if (!isInitialized)
+    {
+        return DrawStatus::NotInitialized;
+    }
+    if (seated.empty())
+    {
+        return DrawStatus::NoSeatingChart;
+    }
+    if (mode == SpatialMode::NonAdjacent && (number < 0 || number > static_cast<int>(students.size())))
+    {
+        return DrawStatus::NotEnoughStudents;
+    }
+    if (drawnCount >= students.size())
+    {
+        NextEpoch();
+    }
+    return mode == SpatialMode::NonAdjacent ? DrawNonAdjacent(number, picked, gen) : DrawCluster(picked, gen);
+}
+
+// 每选中一人就把他和周围的同学标记为本次不可选，判断候选人只需一次数组访问，每选一人的代价为 O(1)
+DrawStatus RandomEngine::DrawNonAdjacent(int number, vector<int>& picked, RandomStream& gen)
+{
+    if (static_cast<size_t>(number) > students.size() - drawnCount)
+    {
+        return DrawStatus::NotEnoughAvailable;
+    }
+    if (++blockStamp == 0)
+    {
+        fill(blockedStamp.begin(), blockedStamp.end(), 0);
+        blockStamp = 1;
+    }
+    auto eligible = [&](int index) { return !IsDrawn(index) && blockedStamp[index] != blockStamp; };
+    auto accept = [&](int index) {
+        picked.push_back(index);
+        blockedStamp[index] = blockStamp;
+        ForEachNeighbour(index, [&](int neighbour) { blockedStamp[neighbour] = blockStamp; });
+    };
+
+    for (int attempts = 8 * number + 32; static_cast<int>(picked.size()) < number && attempts > 0; attempts--)
+    {
+        int candidate = static_cast<int>(gen.Below(students.size()));
+        if (eligible(candidate)) accept(candidate);
+    }
+
+    // 可选的人太少，拒绝采样迟迟选不满：收集剩余可选的学生，按随机顺序逐个尝试
+    if (static_cast<int>(picked.size()) < number)
+    {
+        vector<int> candidates;
+        for (size_t i = 0; i < students.size(); i++)
+        {
+            if (eligible(static_cast<int>(i))) candidates.push_back(static_cast<int>(i));
+        }
+        for (size_t i = 0; i < candidates.size() && static_cast<int>(picked.size()) < number; i++)
+        {
+            swap(candidates[i], candidates[gen.Between(i, candidates.size() - 1)]);
+            if (eligible(candidates[i])) accept(candidates[i]);
+        }
+    }
+    if (static_cast<int>(picked.size()) < number)
+    {
+        picked.clear();
+        return DrawStatus::NotEnoughAvailable;
+    }
+    for (int index : picked)
+        MarkDrawn(index);
+    return DrawStatus::Ok;
+}
+
+DrawStatus RandomEngine::DrawCluster(vector<int>& picked, RandomStream& gen)
+{
+    int center = -1;
+    for (int attempts = 64; center < 0 && attempts > 0; attempts--)
+    {
+        int candidate = seated[gen.Below(seated.size())];
+        if (!IsDrawn(candidate)) center = candidate;
+    }
+    if (center < 0)
+    {
+        vector<int> candidates;
+        for (int index : seated)
+        {
+            if (!IsDrawn(index)) candidates.push_back(index);
+        }
+        if (candidates.empty())
+        {
+            return DrawStatus::NotEnoughAvailable;
+        }
+        center = candidates[gen.Below(candidates.size())];
+    }
+    picked.push_back(center);
+    ForEachNeighbour(center, [&](int neighbour) { picked.push_back(neighbour); });
+    for (int index : picked)
+    {
+        if (!IsDrawn(index)) MarkDrawn(index);
+    }
+    return DrawStatus::Ok;
+}
+
+const char* DrawStatusMessage(DrawStatus status)
+{
+    switch (status)
+    {
+    case DrawStatus::NotInitialized: return "Not Initialized!";
+    case DrawStatus::NotEnoughStudents: return "Not enough students!";
+    case DrawStatus::NotEnoughAvailable: return "Not enough available students!";
+    case DrawStatus::NoSeatingChart: return "No seating chart!";
+    case DrawStatus::ExclusionConflict: return "Exclusion constraints cannot be satisfied!";
+    default: return "";
+    }
+}
@@ -0,0 +1,296 @@
+// 抽取引擎：名单、已抽取历史与抽取算法
+// Random.cpp 中的导出函数持有一个全局实例并负责加锁与输出格式，
+// 测试与统计工具可以各自创建独立实例并行运行
+
+#pragma once
+#include "Rng.h"
+#include "ScoreTable.h"
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+enum class DrawStatus
+{
+    Ok,
+    NotInitialized,          // 尚未导入名单
+    NotEnoughStudents,       // 请求人数超过名单人数
+    NotEnoughAvailable,      // 请求人数超过本轮剩余未抽取人数
+    NoSeatingChart,          // 名单没有座位行列
+    ExclusionConflict,       // 在互斥约束下凑不出 number 名可同时抽中的学生
+};
+
+// 分层抽取方式
+enum class StratifyMode
+{
+    OnePerGroup,             // 每组抽一人
+    Proportional,            // 共抽 number 人，按各组本轮剩余人数成比例分配名额（最大余数法）
+};
+
+// 按座位抽取方式（相邻指前后左右及斜对角的八个座位）
+enum class SpatialMode
+{
+    NonAdjacent,             // 抽 number 人，两两不相邻
+    Cluster,                 // 随机抽一人及其周围所有同学（忽略 number）
+};
+
+// 导入时按标题额外读取的列，为空表示不读取
+struct RosterColumns
+{
+    std::string group;       // 分组列
+    std::string row;         // 座位行号列（整数）
+    std::string column;      // 座位列号列（整数）
+    bool ids = false;        // 保留第一列作为学号（名单集合运算按学号匹配时需要）
+};
+
+// 座位坐标，行号无法解析时视为没有座位
+struct Seat
+{
+    static constexpr int NONE = INT32_MIN;
+    int row = NONE;
+    int column = NONE;
+};
+
+class RandomEngine
+{
+public:
+    // 从 CSV 文件导入名单（第一行为标题，第二列为姓名），失败时弹出提示并返回 -1，旧名单同样清空
+    // columns 中指定的列在标题行中找不到时同样返回 -1
+    int Import(const std::string& filePath, const RosterColumns& columns = {});
+    // 直接载入名单（去除空名与重复名），名单为空时返回 -1，座位分布过于稀疏时返回 -2；失败后视为尚未导入名单
+    // groups 为空时全体学生同属一组，seats 为空时没有座位表，ids 为空时不保留学号，否则均与 names 一一对应
+    int Load(const std::vector<std::string>& names, const std::vector<std::string>& groups = {},
+        const std::vector<Seat>& seats = {}, const std::vector<std::string>& ids = {});
+
+    // 抽取 number 名学生，被抽中的下标依次写入 picked
+    // 有互斥约束且 number ≥ 2 时逐个在“可选且与已选者都不互斥”的学生中均匀选取，走入死路时回溯；
+    // 本轮剩余的学生凑不出满足约束的组合时视为本轮结束，清空历史后在全体学生中重抽；
+    // 只有全体学生中也不存在这样的组合时才返回 ExclusionConflict（不改变历史）
+    // 不传入随机数生成器时使用当前线程中与本名单模式（SetRandomMode）相同的随机数流（Rng::ThreadStream）
+    DrawStatus Draw(int number, std::vector<int>& picked);
+    DrawStatus Draw(int number, std::vector<int>& picked, RandomStream& gen);
+
+    // 分层抽取：在每组的下标区间内各自抽取，被抽中的下标按组的先后写入 picked
+    // OnePerGroup 忽略 number；某组本轮已全部抽过时在该组全体中抽一人（计为重复，不影响其他组）
+    DrawStatus DrawStratified(StratifyMode mode, int number, std::vector<int>& picked);
+    DrawStatus DrawStratified(StratifyMode mode, int number, std::vector<int>& picked, RandomStream& gen);
+
+    // 按座位抽取，被抽中的下标写入 picked；名单没有座位行列时返回 NoSeatingChart
+    // NonAdjacent 先在全体学生中拒绝采样，尝试次数用尽后改为按随机顺序扫描；
+    // 依次贪心选取，找不到 number 个两两不相邻的剩余学生时返回 NotEnoughAvailable 且不改变历史
+    // Cluster 以本轮未抽中的一名有座位的学生为中心，先输出中心再按行优先输出周围的同学（周围的同学即使本轮已抽过也包含在内）
+    DrawStatus DrawSpatial(SpatialMode mode, int number, std::vector<int>& picked);
+    DrawStatus DrawSpatial(SpatialMode mode, int number, std::vector<int>& picked, RandomStream& gen);
+
+    // 清空已抽取历史：只推进轮次编号，O(1)
+    void ClearHistory();
+
+    // 冷却：最近被抽中的 picks 人（按人次计，跨轮次）在 Draw 中不会再被抽中，0 表示关闭
+    // 与“一轮内不重复”同时生效，主要作用是新一轮开始时不会立刻抽到上一轮最后几名；
+    // 遵守冷却会使本来能完成的抽取失败时，本次抽取忽略冷却。分层与按座位抽取不受冷却限制，但抽中者同样进入冷却
+    // 设置时清空冷却记录与撤销记录；冷却记录不进入状态快照
+    void SetCooldown(size_t picks);
+    size_t Cooldown() const { return recentPicks.size(); }
+
+    // 随机数模式：只影响不传入生成器的抽取；Secure 使用 ChaCha20，已公布的结果无助于预测之后的抽取
+    // 不进入状态快照，导入名单时保留
+    void SetRandomMode(RandomMode mode) { randomMode = mode; }
+    RandomMode Mode() const { return randomMode; }
+
+    // 互斥约束：a 与 b 不会在同一次 Draw 中被同时抽中（按位图存放，每名涉及约束的学生一行）
+    // 学生下标无效或 a == b 时返回 false；导入名单时清空。分层与按座位抽取不受互斥约束限制
+    bool AddExclusion(int a, int b);
+    void ClearExclusions();
+    size_t ExclusionCount() const { return exclusionPairs; }
+    // 全部约束 (a, b)，a < b，按 a、b 升序
+    void Exclusions(std::vector<std::pair<int, int>>& pairs) const;
+    bool Excluded(int a, int b) const
+    {
+        int row = exclusionRow[a];
+        return row >= 0 && (exclusionBits[row * exclusionWords + b / 64] >> (b % 64) & 1);
+    }
+
+    // 撤销最近一次抽取或清空（含抽取前的自动清空），被放回的学生下标写入 reverted；没有可撤销的记录时返回 false
+    // 重做按原样重新抽中同一批学生；撤销后又有新的抽取或清空时，尚未重做的记录作废
+    // 最多保留 UNDO_LIMIT 条记录，每条的代价与该次抽中人数成正比
+    static constexpr size_t UNDO_LIMIT = 32;
+    bool Undo(std::vector<int>& reverted);
+    bool Redo(std::vector<int>& reapplied);
+    size_t UndoDepth() const { return undoCount; }
+    size_t RedoDepth() const { return redoCount; }
+
+
+    // 积分：导入名单时清零，加分可为负（饱和到 int32 范围），返回新积分；不进入撤销记录
+    int32_t AddScore(int index, int32_t points) { return scores.Add(index, points); }
+    int32_t Score(int index) const { return scores.Score(index); }
+    // 积分最高（highest 为 false 时为最低）的 k 名学生按名次写入 ranked，O(k log n)
+    void Ranking(size_t k, bool highest, std::vector<int>& ranked) const { scores.Top(k, highest, ranked); }
+    void ClearScores() { scores.Reset(students.size()); }
+
+    // 状态快照：名单指纹（姓名、分组与座位的哈希）、轮次、每名学生与每组的历史、积分以及冷却与撤销记录，带版本号与 CRC32 校验
+    // 只能恢复到指纹相同的名单上；恢复只覆盖已有数组，不逐个分配
+    // 版本 1 的快照没有积分，积分清零；版本 1、2 没有冷却与撤销记录，恢复时保留当前冷却记录、清空撤销记录
+    // 随机数流不在快照中：流属于线程或名单句柄而不属于名单，恢复旧的流状态会重复已经用过的随机数（安全模式下即可预测此后的抽取）
+    static constexpr uint16_t STATE_VERSION = 3;
+    enum class StateError { Ok, NotInitialized, Corrupted, RosterMismatch };
+    void SaveState(std::string& out) const;
+    StateError LoadState(std::string_view data);
+
+    // 第 index 名学生是否在最近 rounds 轮内（含本轮）被抽中过，rounds 为 1 时即“本轮是否已抽中”
+    bool DrawnWithin(int index, uint32_t rounds) const;
+
+    bool IsInitialized() const { return isInitialized; }
+    size_t Size() const { return students.size(); }
+    size_t HistorySize() const { return drawnCount; }
+    const std::string& Name(int index) const { return students[index]; }
+    // 按姓名查找学生下标，不存在时返回 -1；索引在第一次查找时构建（按姓名哈希排序），之后每次 O(log n)
+    int Find(std::string_view name) const;
+    size_t GroupCount() const { return groupNames.size(); }
+    const std::string& GroupName(int group) const { return groupNames[group]; }
+    int GroupOf(int index) const { return groupOf[index]; }
+    bool HasSeatingChart() const { return !seated.empty(); }
+    bool HasIds() const { return !ids.empty(); }
+    const std::string& Id(int index) const { return ids[index]; }
+    Seat SeatOf(int index) const;
+    // 两名学生是否相邻（没有座位的学生与任何人都不相邻）
+    bool Adjacent(int a, int b) const;
+
+private:
+    // 小 k 专用内核（拒绝采样），剩余人数太少时返回 false 交给通用路径
+    // available 为可选人数，cooling 为 true 时冷却中的学生不可选
+    template <int K>
+    bool DrawSmall(size_t available, bool cooling, std::vector<int>& picked, RandomStream& gen);
+
+    // 带互斥约束的抽取：masks 第 depth 行为已选 depth 人后仍可选的学生位图，返回是否凑齐 number 人
+    DrawStatus DrawExclusive(int number, bool cooling, std::vector<int>& picked, RandomStream& gen);
+    bool SearchExclusive(int depth, int number, std::vector<uint64_t>& masks, std::vector<int>& chosen, RandomStream& gen);
+
+    // 在第 group 组本轮未抽取的学生中不重复地抽 count 人（count 不超过该组剩余人数）
+    void DrawFromGroup(int group, int count, std::vector<int>& picked, RandomStream& gen);
+    size_t GroupAvailable(int group) const
+    {
+        size_t size = groupStart[group + 1] - groupStart[group];
+        return groupEpoch[group] == epoch ? size - groupDrawn[group] : size;
+    }
+
+    // 对第 index 名学生周围有人的座位逐个调用 visit(下标)，按行优先顺序
+    template <class Visit>
+    void ForEachNeighbour(int index, Visit visit) const;
+    DrawStatus DrawNonAdjacent(int number, std::vector<int>& picked, RandomStream& gen);
+    DrawStatus DrawCluster(std::vector<int>& picked, RandomStream& gen);
+
+    // 一次抽取或清空对历史的全部改动：每名被标记学生的旧值，以及前后的轮次与人数
+    struct DrawMark
+    {
+        int index;
+        uint32_t lastEpoch;                     // 该学生原先的 lastDrawnEpoch
+        uint32_t groupEpoch;                    // 所在组原先的 groupEpoch 与 groupDrawn
+        uint32_t groupDrawn;
+        int evicted;                            // 被挤出冷却环形缓冲区的学生，-1 表示没有
+    };
+    struct DrawRecord
+    {
+        std::vector<DrawMark> marks;
+        uint32_t epochBefore, epochAfter;
+        size_t drawnBefore, drawnAfter;
+    };
+    // 公开的抽取与清空函数用 RecordScope 包住，期间的 NextEpoch 与 MarkDrawn 记入 pending，结束时有改动才入栈
+    struct RecordScope
+    {
+        RandomEngine& engine;
+        explicit RecordScope(RandomEngine& engine);
+        ~RecordScope();
+    };
+    void ResetUndo() { undoCount = redoCount = 0; recording = false; }
+    // 最近记录：冷却缓冲区与撤销、重做记录的紧凑编码，存入状态快照（版本 3 起）
+    // 只能恢复到人数相同的名单上；先检查全部下标与人数，失败时返回 false，原状态不变
+    void SaveRecent(std::string& out) const;
+    bool LoadRecent(std::string_view data);
+
+    bool IsDrawn(int index) const { return lastDrawnEpoch[index] == epoch; }
+    bool IsCooling(int index) const { return coolingCount[index] != 0; }
+    void MarkDrawn(int index)
+    {
+        if (recording)
+        {
+            int g = groupOf[index];
+            pending.marks.push_back({ index, lastDrawnEpoch[index], groupEpoch[g], groupDrawn[g], -1 });
+        }
+        if (!recentPicks.empty())
+            CoolDown(index);
+        lastDrawnEpoch[index] = epoch;
+        drawnCount++;
+        int group = groupOf[index];
+        if (groupEpoch[group] != epoch)
+        {
+            groupEpoch[group] = epoch;
+            groupDrawn[group] = 0;
+        }
+        groupDrawn[group]++;
+    }
+    void NextEpoch();
+    // 把 index 放入冷却环形缓冲区，挤出最早的一人，返回被挤出者（-1 表示没有）；index 必须是本轮尚未抽中的学生
+    int CoolDown(int index);
+    void CountCooling();
+
+    std::vector<std::string> students;          // 学生名单
+    std::vector<std::string> ids;               // 学号（第一列），只在导入时要求保留时非空
+    bool isInitialized = false;                 // 是否已初始化
+    std::vector<uint32_t> lastDrawnEpoch;       // 每名学生最近一次被抽中时的轮次，0 表示从未抽中
+    uint32_t epoch = 1;                         // 当前轮次，清空历史时加一
+    size_t drawnCount = 0;                      // 本轮已抽取人数
+
+    // 分组索引（导入时构建）：第 g 组的学生下标为 groupMembers[groupStart[g], groupStart[g + 1])
+    std::vector<std::string> groupNames;        // 各组名称，按在名单中首次出现的顺序
+    std::vector<int> groupOf;                   // 每名学生所在的组
+    std::vector<int> groupMembers;              // 按组排列的学生下标
+    std::vector<int> groupStart;                // 各组在 groupMembers 中的起点，末尾多一项
+    std::vector<uint32_t> groupEpoch;           // groupDrawn 记录的轮次，不等于当前轮次时视为 0
+    std::vector<uint32_t> groupDrawn;           // 各组本轮已抽取人数
+
+    // 座位表（导入时构建）：按行优先存放的紧凑网格，覆盖所有座位的外接矩形
+    std::vector<int> seatGrid;                  // 每个格子上的学生下标，-1 表示空座
+    int gridRowMin = 0, gridColumnMin = 0;      // 网格左上角对应的行号、列号
+    int gridRows = 0, gridColumns = 0;
+    std::vector<int> seatCell;                  // 每名学生所在的格子，-1 表示没有座位
+    std::vector<int> seated;                    // 有座位的学生下标
+    uint64_t rosterHash = 0;                    // 名单指纹，导入时计算
+    ScoreTable scores;                          // 积分与积分排名
+    mutable std::vector<std::pair<size_t, int>> nameIndex; // (姓名哈希, 下标) 按哈希排序，Find 时按需构建
+    std::vector<uint32_t> blockedStamp;         // 等于 blockStamp 时表示本次抽取中已被选中或与已选中者相邻
+    uint32_t blockStamp = 0;
+
+    // 撤销记录：环形缓冲区，undoHead 之前的 undoCount 条可撤销，其后的 redoCount 条可重做；槽位复用，不反复分配
+    std::vector<DrawRecord> undoRing = std::vector<DrawRecord>(UNDO_LIMIT);
+    size_t undoHead = 0;
+    size_t undoCount = 0;
+    size_t redoCount = 0;
+    DrawRecord pending;                         // 正在进行的抽取，入栈时与 undoHead 处的槽位交换
+    bool recording = false;
+
+    // 冷却：最近抽中者的环形缓冲区，容量即冷却人次；每名学生在缓冲区中出现的次数
+    RandomMode randomMode = RandomMode::Fast;
+    std::vector<int> recentPicks;               // -1 表示空槽
+    size_t recentHead = 0;                      // 下一个写入的槽位
+    std::vector<uint32_t> coolingCount;
+    size_t coolingStudents = 0;                 // 冷却中的学生人数（去重）
+    size_t coolingAvailable = 0;                // 其中本轮尚未抽中的人数，Draw 据此扣除可选人数
+
+    // 互斥约束：邻接位图，只为涉及约束的学生分配一行，每行 exclusionWords 个 64 位字
+    std::vector<int> exclusionRow;              // 每名学生的行号，-1 表示没有约束
+    std::vector<uint64_t> exclusionBits;
+    size_t exclusionWords = 0;
+    size_t exclusionPairs = 0;
+    std::vector<uint64_t> exclusionMasks;       // DrawExclusive 的逐层候选位图，复用以免每次分配
+};
+
+// 抽取失败时返回给调用方的提示文本
+const char* DrawStatusMessage(DrawStatus status);
+
+// 从 Random.cpp 的全局名单中加锁抽取，姓名以两个空格分隔写入 output（SimpleRandom 与本地 IPC 服务共用）；
+// AnimatedRandom 的动画名单另以换行分隔，见 Random.cpp
+DrawStatus DrawNames(int number, std::string& output);
+DrawStatus DrawStratifiedNames(StratifyMode mode, int number, std::string& output);
+DrawStatus DrawSpatialNames(SpatialMode mode, int number, std::string& output);
@@ -0,0 +1,238 @@
+#include "pch.h"
+#include "Rng.h"
+#include "EntropyPool.h"
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
+using namespace std;
+
+static uint64_t SplitMix64(uint64_t& x)
+{
+    uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+Xoshiro256::Xoshiro256(uint64_t seed)
+{
+    for (uint64_t& word : s)
+        word = SplitMix64(seed);
+}
+
+Xoshiro256::Xoshiro256(const array<uint64_t, 4>& state) : s(state)
+{
+    if ((s[0] | s[1] | s[2] | s[3]) == 0)
+        *this = Xoshiro256(0);
+}
+
+// 跳跃多项式来自 xoshiro256** 的参考实现：按多项式的每一位推进生成器并累加状态
+static void Advance(array<uint64_t, 4>& s, const uint64_t (&polynomial)[4], Xoshiro256& gen)
+{
+    array<uint64_t, 4> sum = {};
+    for (uint64_t word : polynomial)
+    {
+        for (int b = 0; b < 64; b++)
+        {
+            if (word & (1ull << b))
+                for (int i = 0; i < 4; i++) sum[i] ^= s[i];
+            gen();
+        }
+    }
+    s = sum;
+}
+
+void Xoshiro256::Jump()
+{
+    static const uint64_t JUMP[4] = { 0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull };
+    Advance(s, JUMP, *this);
+}
+
+void Xoshiro256::LongJump()
+{
+    static const uint64_t LONG_JUMP[4] = { 0x76E15D3EFEFDCBBFull, 0xC5004E441C522FB3ull, 0x77710069854EE241ull, 0x39109BB02ACBE635ull };
+    Advance(s, LONG_JUMP, *this);
+}
+
+ChaCha20::ChaCha20(const array<uint32_t, 8>& key, uint64_t nonce) : key(key), nonce(nonce)
+{
+}
+
+// 四分之一轮按“各块的同一个字”成组运算：有 SSE2 时一组为 4 个块（一个 __m128i），否则逐块运算
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+struct Lanes
+{
+    static constexpr int WIDTH = 4;
+    __m128i v;
+
+    static Lanes Load(const uint32_t* p) { return { _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)) }; }
+    void Store(uint32_t* p) const { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    Lanes operator+(Lanes o) const { return { _mm_add_epi32(v, o.v) }; }
+    Lanes operator^(Lanes o) const { return { _mm_xor_si128(v, o.v) }; }
+    template <int N> Lanes Rotate() const { return { _mm_or_si128(_mm_slli_epi32(v, N), _mm_srli_epi32(v, 32 - N)) }; }
+};
+#else
+struct Lanes
+{
+    static constexpr int WIDTH = 1;
+    uint32_t v;
+
+    static Lanes Load(const uint32_t* p) { return { *p }; }
+    void Store(uint32_t* p) const { *p = v; }
+    Lanes operator+(Lanes o) const { return { v + o.v }; }
+    Lanes operator^(Lanes o) const { return { v ^ o.v }; }
+    template <int N> Lanes Rotate() const { return { rotl(v, N) }; }
+};
+#endif
+
+template <int A, int B, int C, int D>
+static inline void QuarterRound(Lanes (&x)[16])
+{
+    x[A] = x[A] + x[B]; x[D] = (x[D] ^ x[A]).Rotate<16>();
+    x[C] = x[C] + x[D]; x[B] = (x[B] ^ x[C]).Rotate<12>();
+    x[A] = x[A] + x[B]; x[D] = (x[D] ^ x[A]).Rotate<8>();
+    x[C] = x[C] + x[D]; x[B] = (x[B] ^ x[C]).Rotate<7>();
+}
+
+void ChaCha20::Refill()
+{
+    static_assert(LANES % Lanes::WIDTH == 0);
+    static const uint32_t SIGMA[4] = { 0x61707865, 0x3320646E, 0x79622D32, 0x6B206574 }; // "expand 32-byte k"
+    alignas(16) uint32_t input[16][LANES], words[16][LANES];
+    for (int l = 0; l < LANES; l++)
+    {
+        uint64_t block = counter + l;
+        for (int i = 0; i < 4; i++) input[i][l] = SIGMA[i];
+        for (int i = 0; i < 8; i++) input[4 + i][l] = key[i];
+        input[12][l] = static_cast<uint32_t>(block);
+        input[13][l] = static_cast<uint32_t>(block >> 32);
+        input[14][l] = static_cast<uint32_t>(nonce);
+        input[15][l] = static_cast<uint32_t>(nonce >> 32);
+    }
+    counter += LANES;
+    for (int g = 0; g < LANES; g += Lanes::WIDTH)
+    {
+        Lanes x[16];
+        for (int i = 0; i < 16; i++)
+            x[i] = Lanes::Load(&input[i][g]);
+        for (int round = 0; round < 10; round++)
+        {
+            QuarterRound<0, 4, 8, 12>(x);
+            QuarterRound<1, 5, 9, 13>(x);
+            QuarterRound<2, 6, 10, 14>(x);
+            QuarterRound<3, 7, 11, 15>(x);
+            QuarterRound<0, 5, 10, 15>(x);
+            QuarterRound<1, 6, 11, 12>(x);
+            QuarterRound<2, 7, 8, 13>(x);
+            QuarterRound<3, 4, 9, 14>(x);
+        }
+        for (int i = 0; i < 16; i++)
+            (x[i] + Lanes::Load(&input[i][g])).Store(&words[i][g]);
+    }
+    for (int l = 0; l < LANES; l++)
+        for (int i = 0; i < 8; i++)
+            buffer[l * 8 + i] = words[2 * i][l] | static_cast<uint64_t>(words[2 * i + 1][l]) << 32;
+    used = 0;
+}
+
+void ChaCha20::Fill(uint8_t* out, size_t size)
+{
+    for (size_t i = 0; i < size; i += 8)
+    {
+        uint64_t word = (*this)();
+        for (size_t b = 0; b < 8 && i + b < size; b++)
+            out[i + b] = static_cast<uint8_t>(word >> (8 * b));
+    }
+}
+
+// 从熵池取种子或密钥；系统熵源不可用时退回 random_device
+static void SystemRandom(uint32_t* words, size_t count)
+{
+    if (Entropy::Fill(reinterpret_cast<uint8_t*>(words), count * sizeof(uint32_t)))
+        return;
+    random_device rd;
+    for (size_t i = 0; i < count; i++)
+        words[i] = rd();
+}
+
+namespace
+{
+    // 主流：两段起点相隔 2^192 步，前一段分给名单句柄，后一段分给线程
+    struct StreamRoots
+    {
+        mutex lock;
+        Xoshiro256 rosters{ 0 };
+        Xoshiro256 threads{ 0 };
+
+        StreamRoots()
+        {
+            uint32_t words[8];
+            SystemRandom(words, 8);
+            array<uint64_t, 4> state;
+            for (int i = 0; i < 4; i++)
+                state[i] = static_cast<uint64_t>(words[2 * i]) << 32 | words[2 * i + 1];
+            rosters = Xoshiro256(state);
+            threads = rosters;
+            threads.LongJump();
+        }
+
+        Xoshiro256 Split(Xoshiro256& root)
+        {
+            lock_guard<mutex> guard(lock);
+            Xoshiro256 stream = root;
+            root.Jump();
+            return stream;
+        }
+    };
+
+    StreamRoots& Roots()
+    {
+        static StreamRoots roots;
+        return roots;
+    }
+}
+
+static ChaCha20 NewSecureGenerator()
+{
+    array<uint32_t, 8> key;
+    SystemRandom(key.data(), key.size());
+    return ChaCha20(key, 0);
+}
+
+RandomStream Rng::NewStream(RandomMode mode)
+{
+    if (mode == RandomMode::Secure)
+        return RandomStream(NewSecureGenerator());
+    return RandomStream(Roots().Split(Roots().rosters));
+}
+
+RandomStream& Rng::ThreadStream(RandomMode mode)
+{
+    if (mode == RandomMode::Secure)
+    {
+        thread_local RandomStream secure(NewSecureGenerator());
+        return secure;
+    }
+    thread_local RandomStream fast(Roots().Split(Roots().threads));
+    return fast;
+}
+
+void RandomStream::Fill(uint8_t* out, size_t size)
+{
+    if (mode == RandomMode::Secure)
+    {
+        secure->Fill(out, size);
+        return;
+    }
+    for (size_t i = 0; i < size; i += 8)
+    {
+        uint64_t word = fast();
+        for (size_t j = 0; j < 8 && i + j < size; j++)
+            out[i + j] = static_cast<uint8_t>(word >> (8 * j));
+    }
+}
+
+void Rng::SecureBytes(uint8_t* out, size_t size)
+{
+    ThreadStream(RandomMode::Secure).Fill(out, size);
+}
@@ -0,0 +1,167 @@
+// 随机数流：xoshiro256**（64 位输出，周期 2^256 - 1），满足 UniformRandomBitGenerator；抽取用 RandomStream::Below 取整数而不经 <random> 的分布
+// 独立的流由跳跃函数得到：Jump 前进 2^128 步，LongJump 前进 2^192 步，从同一起点依次跳跃得到的各段互不重叠。
+// 每个名单句柄、每个线程各持有一条流，抽取时既不共享状态也不加锁；只有分出新流时才短暂锁住主流。
+// 安全模式改用 ChaCha20 密钥流：不知道密钥时，看到此前的全部输出也无法预测下一个输出
+
+#pragma once
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+class Xoshiro256
+{
+public:
+    using result_type = uint64_t;
+
+    // 用 SplitMix64 把 64 位种子展开为 256 位状态（固定种子用于测试与基准测试）
+    explicit Xoshiro256(uint64_t seed = 0);
+    // 直接指定状态，全零状态无效，会被替换为种子 0 展开的状态
+    explicit Xoshiro256(const std::array<uint64_t, 4>& state);
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+    result_type operator()()
+    {
+        uint64_t result = std::rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = std::rotl(s[3], 45);
+        return result;
+    }
+
+    void Jump();
+    void LongJump();
+
+private:
+    std::array<uint64_t, 4> s;
+};
+
+// ChaCha20（20 轮，64 位块计数器与 64 位 nonce，与 RFC 7539 在 nonce 为 0 时的密钥流相同）
+// 一次生成 LANES 个块放入缓冲区：各块的同一个字放在相邻位置，四分之一轮对所有块逐字运算，编译器可向量化
+class ChaCha20
+{
+public:
+    using result_type = uint64_t;
+
+    ChaCha20(const std::array<uint32_t, 8>& key, uint64_t nonce);
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+    result_type operator()()
+    {
+        if (used == BUFFER_WORDS)
+            Refill();
+        return buffer[used++];
+    }
+
+    // 按字节输出密钥流（小端序），供生成密钥等需要字节的场合
+    void Fill(uint8_t* out, size_t size);
+
+private:
+    static constexpr int LANES = 8;
+    static constexpr size_t BUFFER_WORDS = LANES * 8; // 每块 64 字节
+
+    void Refill();
+
+    std::array<uint32_t, 8> key;
+    uint64_t nonce;
+    uint64_t counter = 0;
+    size_t used = BUFFER_WORDS;
+    alignas(64) std::array<uint64_t, BUFFER_WORDS> buffer;
+};
+
+enum class RandomMode
+{
+    Fast,                    // xoshiro256**（默认）
+    Secure,                  // ChaCha20，由系统熵源取得密钥
+};
+
+// 抽取引擎使用的随机数生成器：按模式转发给 xoshiro256** 或 ChaCha20，分支在同一条流上总是同一方向
+class RandomStream
+{
+public:
+    using result_type = uint64_t;
+
+    explicit RandomStream(uint64_t seed = 0) : fast(seed) {}
+    explicit RandomStream(const Xoshiro256& fast) : fast(fast) {}
+    explicit RandomStream(const ChaCha20& secure) : mode(RandomMode::Secure), secure(secure) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+    result_type operator()() { return mode == RandomMode::Fast ? fast() : (*secure)(); }
+
+    RandomMode Mode() const { return mode; }
+    // 按字节输出（小端序），安全模式即 ChaCha20 的密钥流
+    void Fill(uint8_t* out, size_t size);
+
+    // [0, bound) 上的均匀整数（bound > 0）：Lemire 的乘法取高位并拒绝偏差区间，算法固定，
+    // 不同标准库的 uniform_int_distribution 各不相同，抽取一律用它，可验证会话的记录才能在任何平台上重放
+    uint64_t Below(uint64_t bound)
+    {
+        uint64_t low;
+        uint64_t high = MulHigh((*this)(), bound, low);
+        if (low < bound)
+        {
+            uint64_t threshold = (0 - bound) % bound;
+            while (low < threshold)
+                high = MulHigh((*this)(), bound, low);
+        }
+        return high;
+    }
+    // [low, high] 上的均匀整数
+    template <class T>
+    T Between(T low, T high) { return static_cast<T>(low + static_cast<T>(Below(static_cast<uint64_t>(high - low) + 1))); }
+    // Fisher-Yates：第 i 位与 [i, n) 中均匀选取的一位交换，从前往后
+    template <class It>
+    void Shuffle(It first, It last)
+    {
+        for (auto n = last - first, i = decltype(n)(0); i + 1 < n; i++)
+            std::swap(first[i], first[i + static_cast<decltype(n)>(Below(static_cast<uint64_t>(n - i)))]);
+    }
+
+private:
+    // 64 × 64 位乘法，返回高 64 位，低 64 位写入 low
+    static uint64_t MulHigh(uint64_t a, uint64_t b, uint64_t& low)
+    {
+#if defined(__SIZEOF_INT128__)
+        unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+        low = static_cast<uint64_t>(product);
+        return static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+        uint64_t high;
+        low = _umul128(a, b, &high);
+        return high;
+#else
+        uint64_t aLow = a & 0xFFFFFFFFu, aHigh = a >> 32, bLow = b & 0xFFFFFFFFu, bHigh = b >> 32;
+        uint64_t ll = aLow * bLow, lh = aLow * bHigh, hl = aHigh * bLow;
+        uint64_t middle = (ll >> 32) + (lh & 0xFFFFFFFFu) + (hl & 0xFFFFFFFFu);
+        low = a * b;
+        return aHigh * bHigh + (lh >> 32) + (hl >> 32) + (middle >> 32);
+#endif
+    }
+
+    RandomMode mode = RandomMode::Fast;
+    Xoshiro256 fast;
+    std::optional<ChaCha20> secure;
+};
+
+namespace Rng
+{
+    // 分出一条新的独立流（名单句柄使用）：快速模式的主流从系统熵池（EntropyPool.h）播种一次，每次分出后跳过 2^128 步；
+    // 安全模式每条流各自从熵池取 256 位密钥
+    RandomStream NewStream(RandomMode mode = RandomMode::Fast);
+    // 当前线程的流，第一次使用时分出；线程流与名单句柄的流来自主流 LongJump 隔开的两段，互不重叠
+    RandomStream& ThreadStream(RandomMode mode = RandomMode::Fast);
+    // 用当前线程的安全流（即 ThreadStream(RandomMode::Secure)）填充 size 字节（TOTP 密钥等）
+    void SecureBytes(uint8_t* out, size_t size);
+}
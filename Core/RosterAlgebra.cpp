@@ -0,0 +1,160 @@
+#include "pch.h"
+#include "RosterAlgebra.h"
+#include <bit>
+using namespace std;
+
+// 依次产生规范化后的字节，不分配内存；比较与哈希都直接在原姓名上进行
+class NormalizedBytes
+{
+public:
+    explicit NormalizedBytes(string_view name) : name(name) {}
+
+    // 取下一个字节，结束时返回 -1
+    int Next()
+    {
+        bool space = false;
+        while (pos < name.size())
+        {
+            unsigned char c = static_cast<unsigned char>(name[pos]);
+            size_t width = c == ' ' || c == '\t' ? 1 : c == 0xE3 && name.compare(pos, 3, "\xE3\x80\x80") == 0 ? 3 : 0;
+            if (width == 0) break;
+            space = true;
+            pos += width;
+        }
+        if (pos >= name.size())
+            return -1;
+        if (space && started)
+            return ' '; // 不推进 pos，下一次调用再返回当前字节
+        started = true;
+        unsigned char c = static_cast<unsigned char>(name[pos++]);
+        return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+    }
+
+private:
+    string_view name;
+    size_t pos = 0;
+    bool started = false;
+};
+
+string NormalizeName(string_view name)
+{
+    string out;
+    NormalizedBytes bytes(name);
+    for (int c; (c = bytes.Next()) >= 0;)
+        out += static_cast<char>(c);
+    return out;
+}
+
+uint64_t NormalizedHash(string_view name)
+{
+    uint64_t h = 14695981039346656037ull;
+    NormalizedBytes bytes(name);
+    for (int c; (c = bytes.Next()) >= 0;)
+        h = (h ^ static_cast<uint64_t>(c)) * 1099511628211ull;
+    return h;
+}
+
+bool NormalizedEqual(string_view a, string_view b)
+{
+    NormalizedBytes x(a), y(b);
+    while (true)
+    {
+        int c = x.Next();
+        if (c != y.Next()) return false;
+        if (c < 0) return true;
+    }
+}
+
+namespace
+{
+    // 一份名单每名学生键的哈希；键本身不复制，比较时再从名单中取
+    struct KeyTable
+    {
+        const RandomEngine& roster;
+        RosterKey key;
+        vector<uint64_t> hashes;
+
+        KeyTable(const RandomEngine& roster, RosterKey key) : roster(roster), key(key), hashes(roster.Size())
+        {
+            for (size_t i = 0; i < hashes.size(); i++)
+            {
+                int index = static_cast<int>(i);
+                hashes[i] = key == RosterKey::Id ? hash<string>()(roster.Id(index)) : NormalizedHash(roster.Name(index));
+            }
+        }
+
+        bool Equal(int index, const KeyTable& other, int otherIndex) const
+        {
+            if (hashes[index] != other.hashes[otherIndex])
+                return false;
+            if (key == RosterKey::Id)
+                return roster.Id(index) == other.roster.Id(otherIndex);
+            return NormalizedEqual(roster.Name(index), other.roster.Name(otherIndex));
+        }
+    };
+
+    struct Bitmap
+    {
+        vector<uint64_t> words;
+        explicit Bitmap(size_t bits) : words((bits + 63) / 64) {}
+        void Set(size_t i) { words[i >> 6] |= uint64_t(1) << (i & 63); }
+        bool Test(size_t i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+    };
+}
+
+int CombineRosters(const RandomEngine& a, const RandomEngine& b, SetOp op, RosterKey key, RandomEngine& result)
+{
+    if (key == RosterKey::Id && (!a.HasIds() || !b.HasIds()))
+        return -1;
+    KeyTable left(a, key), right(b, key);
+
+    // 哈希连接：右侧名单的下标放进开放寻址表（线性探测，装载率不超过一半），左侧逐个探测；
+    // 同一键在右侧可能出现多次，因此探测到空槽为止
+    size_t capacity = bit_ceil(max<size_t>(2 * b.Size(), 16));
+    size_t mask = capacity - 1;
+    vector<int> slots(capacity, -1);
+    for (size_t y = 0; y < b.Size(); y++)
+    {
+        size_t pos = right.hashes[y] & mask;
+        while (slots[pos] >= 0) pos = (pos + 1) & mask;
+        slots[pos] = static_cast<int>(y);
+    }
+    Bitmap inRight(a.Size()), inLeft(b.Size());
+    for (size_t x = 0; x < a.Size(); x++)
+    {
+        for (size_t pos = left.hashes[x] & mask; slots[pos] >= 0; pos = (pos + 1) & mask)
+        {
+            if (!left.Equal(static_cast<int>(x), right, slots[pos])) continue;
+            inRight.Set(x);
+            inLeft.Set(slots[pos]);
+        }
+    }
+
+    vector<string> names, groups, ids;
+    vector<Seat> seats;
+    bool withGroups = a.GroupCount() > 1 || b.GroupCount() > 1;
+    bool withSeats = a.HasSeatingChart() || b.HasSeatingChart();
+    bool withIds = a.HasIds() && b.HasIds();
+    auto take = [&](const RandomEngine& roster, int index) {
+        names.push_back(roster.Name(index));
+        if (withGroups) groups.push_back(roster.GroupName(roster.GroupOf(index)));
+        if (withSeats) seats.push_back(roster.SeatOf(index));
+        if (withIds) ids.push_back(roster.Id(index));
+    };
+    for (size_t x = 0; x < a.Size(); x++)
+    {
+        bool matched = inRight.Test(x);
+        if (matched == (op == SetOp::Intersection) || op == SetOp::Union)
+            take(a, static_cast<int>(x));
+    }
+    if (op == SetOp::Union)
+    {
+        for (size_t y = 0; y < b.Size(); y++)
+        {
+            if (!inLeft.Test(y)) take(b, static_cast<int>(y));
+        }
+    }
+    if (names.empty())
+        return -2;
+    return result.Load(names, groups, seats, ids) == 0 ? 0 : -2;
+}
@@ -0,0 +1,28 @@
+// 名单集合运算：交集、差集、并集，按学号或规范化后的姓名匹配
+// 右侧名单按键的哈希建开放寻址表，左侧逐个探测（哈希连接），匹配结果记在按下标的位图里，
+// 再按原名单顺序取出；结果是一份新的名单，保留左侧名单（并集中右侧独有的部分保留右侧）的分组、座位与学号
+
+#pragma once
+#include "RandomEngine.h"
+
+enum class SetOp
+{
+    Intersection,            // 在 a 中且在 b 中
+    Difference,              // 在 a 中但不在 b 中
+    Union,                   // a 的全部，加上 b 中不在 a 里的
+};
+
+enum class RosterKey
+{
+    Name,                    // 规范化后的姓名
+    Id,                      // 第一列学号（两份名单都需在导入时保留学号）
+};
+
+// 规范化姓名：去掉首尾空白，连续空白（含全角空格）合并为一个空格，ASCII 字母转小写
+std::string NormalizeName(std::string_view name);
+// 规范化姓名的哈希（FNV-1a）与相等比较：逐字节规范化，结果与先调用 NormalizeName 相同，但不生成副本
+uint64_t NormalizedHash(std::string_view name);
+bool NormalizedEqual(std::string_view a, std::string_view b);
+
+// 计算 a op b 并载入 result；按学号匹配但名单未保留学号时返回 -1，结果为空或无法载入时返回 -2
+int CombineRosters(const RandomEngine& a, const RandomEngine& b, SetOp op, RosterKey key, RandomEngine& result);
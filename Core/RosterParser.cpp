@@ -0,0 +1,118 @@
+#include "pch.h"
+#include "RosterParser.h"
+using namespace std;
+
+CsvReader::CsvReader(string_view data) : data(data)
+{
+    // 跳过 UTF-8 BOM
+    if (data.size() >= 3 && data.substr(0, 3) == "\xEF\xBB\xBF")
+        pos = 3;
+    if (data.find('\n') == string_view::npos && data.find('\r') != string_view::npos)
+        lineBreak = '\r';
+}
+
+bool CsvReader::Next(vector<string>& fields, size_t& count)
+{
+    count = 0;
+    if (pos >= data.size())
+        return false;
+
+    size_t lineEnd = data.find(lineBreak, pos);
+    if (lineEnd == string_view::npos) lineEnd = data.size();
+    string_view line = data.substr(pos, lineEnd - pos);
+    pos = lineEnd + 1;
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+
+    size_t i = 0;
+    while (true)
+    {
+        if (count == fields.size()) fields.emplace_back();
+        string& field = fields[count++];
+        field.clear();
+
+        // 引号前允许有空白
+        size_t start = i;
+        while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) i++;
+        if (i < line.size() && line[i] == '"')
+        {
+            i++;
+            while (i < line.size())
+            {
+                size_t quote = line.find('"', i);
+                if (quote == string_view::npos) { field.append(line.substr(i)); i = line.size(); break; }
+                field.append(line.substr(i, quote - i));
+                if (quote + 1 < line.size() && line[quote + 1] == '"') { field.push_back('"'); i = quote + 2; continue; }
+                i = quote + 1;
+                break;
+            }
+            // 闭合引号之后到逗号之前的内容原样保留（与 Excel 的宽松处理一致）
+            size_t comma = line.find(',', i);
+            if (comma == string_view::npos) comma = line.size();
+            field.append(line.substr(i, comma - i));
+            i = comma;
+        }
+        else
+        {
+            size_t comma = line.find(',', start);
+            if (comma == string_view::npos) comma = line.size();
+            field.assign(line.substr(start, comma - start));
+            i = comma;
+        }
+
+        if (i >= line.size()) break;
+        i++; // 跳过逗号
+    }
+    return true;
+}
+
+string_view TrimField(string_view field)
+{
+    size_t first = field.find_first_not_of(" \t\n\r");
+    if (first == string_view::npos) return string_view();
+    size_t last = field.find_last_not_of(" \t\n\r");
+    return field.substr(first, last - first + 1);
+}
+
+void ParseRoster(string_view data, vector<string>& names)
+{
+    CsvReader reader(data);
+    vector<string> fields;
+    size_t count;
+    reader.Next(fields, count); // 不保存第一行标题
+    while (reader.Next(fields, count))
+    {
+        if (count < 2) continue;
+        string_view name = TrimField(fields[1]);
+        if (name.empty()) continue;
+        names.emplace_back(name);
+    }
+}
+
+bool ParseRoster(string_view data, vector<string>& names, const vector<string>& columns, vector<vector<string>>& values,
+    vector<string>* ids)
+{
+    CsvReader reader(data);
+    vector<string> fields;
+    size_t count;
+    reader.Next(fields, count);
+    vector<size_t> positions;
+    for (const string& column : columns)
+    {
+        size_t found = 0;
+        while (found < count && TrimField(fields[found]) != column) found++;
+        if (found == count) return false;
+        positions.push_back(found);
+    }
+    values.assign(columns.size(), {});
+    while (reader.Next(fields, count))
+    {
+        if (count < 2) continue;
+        string_view name = TrimField(fields[1]);
+        if (name.empty()) continue;
+        names.emplace_back(name);
+        if (ids) ids->emplace_back(TrimField(fields[0]));
+        for (size_t c = 0; c < positions.size(); c++)
+            values[c].emplace_back(positions[c] < count ? TrimField(fields[positions[c]]) : string_view());
+    }
+    return true;
+}
@@ -0,0 +1,35 @@
+// 名单 CSV 解析
+// 支持 Excel / 记事本导出的常见形式：UTF-8 BOM、CRLF / LF / CR 换行、引号字段（可包含逗号与成对的双引号）。
+// 引号字段不跨行：未闭合的引号在行尾结束，避免一处手误吞掉其后的整个名单。
+
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+
+class CsvReader
+{
+public:
+    explicit CsvReader(std::string_view data);
+
+    // 读取下一行，字段写入 fields 的前 count 个元素（复用已有字符串的容量，避免逐行分配）
+    // 没有更多行时返回 false
+    bool Next(std::vector<std::string>& fields, size_t& count);
+
+private:
+    std::string_view data;
+    size_t pos = 0;
+    char lineBreak = '\n'; // 只有 CR 换行的文件（旧版 Mac Excel 导出）使用 '\r'
+};
+
+// 去除首尾的空格、制表符与换行符
+std::string_view TrimField(std::string_view field);
+
+// 解析名单：跳过标题行，取第二列作为姓名并去除首尾空白，跳过空名（不去重）
+void ParseRoster(std::string_view data, std::vector<std::string>& names);
+
+// 同上，并按标题取出附加列（如分组、座位行列），values[c] 与 names 一一对应，缺少的单元格为空串；
+// ids 非空时另取第一列（学号）。标题行中找不到某一列时返回 false
+bool ParseRoster(std::string_view data, std::vector<std::string>& names,
+    const std::vector<std::string>& columns, std::vector<std::vector<std::string>>& values,
+    std::vector<std::string>* ids = nullptr);
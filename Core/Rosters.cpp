@@ -0,0 +1,179 @@
+// 多名单句柄：在全局名单（Random.cpp）之外同时载入多份名单，各自独立抽取，
+// 也可以把几份名单组成并集视图（UnionRoster）一起抽取，或做集合运算（RosterAlgebra）得到新名单，
+// 再设为全局名单以使用分层、按座位等全部抽取方式
+// 句柄为正整数，释放后不再复用；所有操作由 rosterMutex 保护
+
+#include "pch.h"
+#include "UnionRoster.h"
+#include "RosterAlgebra.h"
+#include "Encoding.h"
+#include "Trace.h"
+#include "Metrics.h"
+#include "VerifiableSession.h"
+#include <unordered_map>
+using namespace std;
+
+extern RandomEngine engine;     // Random.cpp 中的全局名单
+extern mutex randomMutex;
+extern VerifiableSession session;
+
+struct RosterEntry
+{
+    shared_ptr<RandomEngine> roster;    // 普通名单
+    shared_ptr<UnionRoster> view;       // 并集视图（与 roster 二选一）
+    RandomStream stream = Rng::NewStream(); // 每个句柄独立的随机数流
+};
+
+static mutex rosterMutex;
+static unordered_map<int, RosterEntry> rosters;
+static int nextHandle = 1;
+
+static RosterEntry* FindRoster(int handle)
+{
+    auto found = rosters.find(handle);
+    return found == rosters.end() ? nullptr : &found->second;
+}
+
+// 载入名单目录中的 filenameW.csv（保留第一列学号），返回句柄，失败时返回 -1
+EXPORT_DLL int RosterLoad(const wchar_t* filenameW)
+{
+    IC_TRACE_SPAN(TraceOp::Import);
+    auto roster = make_shared<RandomEngine>();
+    RosterColumns columns;
+    columns.ids = true;
+    int result = roster->Import(Platform::GetProfilePath(WideToUtf8(filenameW) + ".csv"), columns);
+    Metrics::Add(Counter::ImportCalls);
+    if (result != 0)
+    {
+        Metrics::Add(Counter::ImportErrors);
+        return -1;
+    }
+    lock_guard<mutex> lock(rosterMutex);
+    rosters.emplace(nextHandle, RosterEntry{ move(roster), nullptr });
+    return nextHandle++;
+}
+
+// 释放句柄；已建立的并集视图仍持有成员名单，不受影响
+EXPORT_DLL void RosterRelease(const int handle)
+{
+    lock_guard<mutex> lock(rosterMutex);
+    rosters.erase(handle);
+}
+
+// 以 count 个名单句柄建立并集视图，返回新句柄；任一句柄无效或本身是视图时返回 -1
+EXPORT_DLL int RosterUnion(const int* handles, const int count)
+{
+    lock_guard<mutex> lock(rosterMutex);
+    vector<shared_ptr<const RandomEngine>> members;
+    for (int i = 0; i < count; i++)
+    {
+        RosterEntry* entry = FindRoster(handles[i]);
+        if (!entry || !entry->roster) return -1;
+        members.push_back(entry->roster);
+    }
+    if (members.empty())
+        return -1;
+    rosters.emplace(nextHandle, RosterEntry{ nullptr, make_shared<UnionRoster>(move(members)) });
+    return nextHandle++;
+}
+
+// 集合运算：op 为 0 交集、1 差集（a 减 b）、2 并集，key 为 0 按规范化姓名、1 按学号匹配
+// 返回新名单的句柄；句柄无效或是视图、按学号匹配但缺少学号时返回 -1，结果为空时返回 -2
+EXPORT_DLL int RosterCombine(const int a, const int b, const int op, const int key)
+{
+    lock_guard<mutex> lock(rosterMutex);
+    RosterEntry* left = FindRoster(a);
+    RosterEntry* right = FindRoster(b);
+    if (!left || !right || !left->roster || !right->roster || op < 0 || op > 2)
+        return -1;
+    auto roster = make_shared<RandomEngine>();
+    int result = CombineRosters(*left->roster, *right->roster, static_cast<SetOp>(op),
+        key == 1 ? RosterKey::Id : RosterKey::Name, *roster);
+    if (result != 0)
+        return result;
+    rosters.emplace(nextHandle, RosterEntry{ move(roster), nullptr });
+    return nextHandle++;
+}
+
+// 把名单复制为全局名单（SimpleRandom、StratifiedRandom、SpatialRandom 与本地 IPC 服务使用的名单），
+// 连同其已抽取历史；成功返回 0，句柄无效或是视图时返回 -1
+EXPORT_DLL int RosterActivate(const int handle)
+{
+    lock_guard<mutex> lock(rosterMutex);
+    RosterEntry* entry = FindRoster(handle);
+    if (!entry || !entry->roster)
+        return -1;
+    lock_guard<mutex> engineLock(randomMutex);
+    engine = *entry->roster;
+    session.Interrupt();
+    Metrics::Set(Gauge::RosterSize, engine.Size());
+    Metrics::Set(Gauge::HistorySize, engine.HistorySize());
+    Metrics::Set(Gauge::UndoDepth, engine.UndoDepth());
+    return 0;
+}
+
+// 名单或视图的人数（视图为去重后的人数），句柄无效时返回 -1
+EXPORT_DLL int RosterSize(const int handle)
+{
+    lock_guard<mutex> lock(rosterMutex);
+    RosterEntry* entry = FindRoster(handle);
+    if (!entry) return -1;
+    return static_cast<int>(entry->roster ? entry->roster->Size() : entry->view->Size());
+}
+
+// 从名单或视图中抽取 number 人，输出格式与 SimpleRandom 相同
+EXPORT_DLL BSTR RosterDraw(const int handle, const int number)
+{
+    IC_TRACE_SPAN(TraceOp::Draw);
+    lock_guard<mutex> lock(rosterMutex);
+    Metrics::Add(Counter::DrawCalls);
+    RosterEntry* entry = FindRoster(handle);
+    DrawStatus status = DrawStatus::NotInitialized;
+    string output;
+    if (entry && entry->roster)
+    {
+        vector<int> picked;
+        status = entry->roster->Draw(number, picked, entry->stream);
+        for (int index : picked)
+            output += (output.empty() ? "" : "  ") + entry->roster->Name(index);
+        Metrics::Add(Counter::StudentsDrawn, picked.size());
+    }
+    else if (entry)
+    {
+        vector<size_t> picked;
+        status = entry->view->Draw(number, picked, entry->stream);
+        for (size_t position : picked)
+            output += (output.empty() ? "" : "  ") + entry->view->Name(position);
+        Metrics::Add(Counter::StudentsDrawn, picked.size());
+    }
+    if (status != DrawStatus::Ok)
+    {
+        Metrics::Add(Counter::DrawErrors);
+        return Platform::AllocString(DrawStatusMessage(status));
+    }
+    return Platform::AllocString(output);
+}
+
+EXPORT_DLL void RosterClearHistory(const int handle)
+{
+    lock_guard<mutex> lock(rosterMutex);
+    RosterEntry* entry = FindRoster(handle);
+    if (!entry) return;
+    if (entry->roster) entry->roster->ClearHistory();
+    else entry->view->ClearHistory();
+    Metrics::Add(Counter::HistoryClears);
+}
+
+// 设置名单或视图的随机数模式（0 快速，1 安全，见 SetRandomMode），换用该模式的新随机数流；
+// 名单的模式随 RosterActivate 带到全局名单。句柄或模式无效时返回 -1
+EXPORT_DLL int RosterSetRandomMode(const int handle, const int mode)
+{
+    if (mode != static_cast<int>(RandomMode::Fast) && mode != static_cast<int>(RandomMode::Secure))
+        return -1;
+    lock_guard<mutex> lock(rosterMutex);
+    RosterEntry* entry = FindRoster(handle);
+    if (!entry) return -1;
+    entry->stream = Rng::NewStream(static_cast<RandomMode>(mode));
+    if (entry->roster) entry->roster->SetRandomMode(static_cast<RandomMode>(mode));
+    return 0;
+}
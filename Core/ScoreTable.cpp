@@ -0,0 +1,62 @@
+#include "pch.h"
+#include "ScoreTable.h"
+#include <bit>
+using namespace std;
+
+void ScoreTable::Reset(size_t count)
+{
+    scores.assign(count, 0);
+    Rebuild();
+}
+
+void ScoreTable::Rebuild()
+{
+    leaves = bit_ceil(max<size_t>(scores.size(), 1));
+    best.assign(2 * leaves, -1);
+    for (size_t i = 0; i < scores.size(); i++)
+        best[leaves + i] = static_cast<int>(i);
+    worst = best;
+    for (size_t node = leaves - 1; node > 0; node--)
+        Update(node);
+}
+
+int32_t ScoreTable::Add(int index, int32_t points)
+{
+    int64_t value = static_cast<int64_t>(scores[index]) + points;
+    scores[index] = static_cast<int32_t>(clamp<int64_t>(value, INT32_MIN, INT32_MAX));
+    for (size_t node = (leaves + index) >> 1; node > 0; node >>= 1)
+        Update(node);
+    return scores[index];
+}
+
+// 候选堆里放子树根，以子树冠军排序；每取出一个子树就输出它的冠军，
+// 再沿冠军所在的路径下行，把路径旁边的兄弟子树放入候选，每输出一人最多新增 log n 个候选
+void ScoreTable::Top(size_t k, bool highest, vector<int>& ranked) const
+{
+    ranked.clear();
+    k = min(k, scores.size());
+    if (k == 0)
+        return;
+    const vector<int>& tree = highest ? best : worst;
+    auto later = [&](size_t a, size_t b) { return Before(tree[b], tree[a], highest); };
+    vector<size_t> candidates = { 1 };
+    candidates.reserve(k * (bit_width(leaves) + 1));
+    while (ranked.size() < k)
+    {
+        pop_heap(candidates.begin(), candidates.end(), later);
+        size_t node = candidates.back();
+        candidates.pop_back();
+        int winner = tree[node];
+        ranked.push_back(winner);
+        while (node < leaves)
+        {
+            size_t next = tree[2 * node] == winner ? 2 * node : 2 * node + 1;
+            if (tree[next ^ 1] >= 0)
+            {
+                candidates.push_back(next ^ 1);
+                push_heap(candidates.begin(), candidates.end(), later);
+            }
+            node = next;
+        }
+    }
+}
@@ -0,0 +1,45 @@
+// 积分表：每名学生一个积分（按下标连续存放），外加按积分排序的锦标赛树（线段树，每个节点记录子树中的最高分与最低分学生）
+// 加分只更新从叶子到根的一条路径，O(log n)；取前 k 名或后 k 名沿冠军路径逐个展开，O(k log n)，不排序整张名单
+
+#pragma once
+#include <cstdint>
+#include <vector>
+
+class ScoreTable
+{
+public:
+    // 重置为 count 名学生，积分全部为 0
+    void Reset(size_t count);
+
+    // 加分（points 可为负，结果饱和到 int32 范围），返回新积分
+    int32_t Add(int index, int32_t points);
+    int32_t Score(int index) const { return scores[index]; }
+
+    // 积分最高（highest 为 false 时为最低）的 k 名学生按名次写入 ranked，同分时名单中靠前者在前
+    void Top(size_t k, bool highest, std::vector<int>& ranked) const;
+
+    // 整体读写积分列（状态快照使用），直接修改后须调用 Rebuild 重建排序树，O(n)
+    std::vector<int32_t>& Values() { return scores; }
+    const std::vector<int32_t>& Values() const { return scores; }
+    void Rebuild();
+
+private:
+    // a 是否排在 b 之前（-1 表示空位，排在所有学生之后）
+    bool Before(int a, int b, bool highest) const
+    {
+        if (a < 0 || b < 0) return b < 0 && a >= 0;
+        if (scores[a] != scores[b]) return highest ? scores[a] > scores[b] : scores[a] < scores[b];
+        return a < b;
+    }
+    void Update(size_t node)
+    {
+        size_t left = 2 * node, right = left + 1;
+        best[node] = Before(best[left], best[right], true) ? best[left] : best[right];
+        worst[node] = Before(worst[left], worst[right], false) ? worst[left] : worst[right];
+    }
+
+    std::vector<int32_t> scores;
+    size_t leaves = 1;                  // 叶子数，不小于人数的 2 的幂；第 i 名学生在节点 leaves + i
+    std::vector<int> best;              // 各节点子树中排名最高的学生下标，节点 1 为根
+    std::vector<int> worst;             // 各节点子树中排名最低的学生下标
+};
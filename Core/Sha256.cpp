@@ -0,0 +1,112 @@
+#include "pch.h"
+#include "Sha256.h"
+#include <bit>
+using namespace std;
+
+static const uint32_t K[64] = {
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+void Sha256::Compress(const uint8_t* block)
+{
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++)
+        w[i] = uint32_t(block[4 * i]) << 24 | uint32_t(block[4 * i + 1]) << 16 | uint32_t(block[4 * i + 2]) << 8 | block[4 * i + 3];
+    for (int i = 16; i < 64; i++)
+    {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; i++)
+    {
+        uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+        uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+void Sha256::Update(const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    length += size;
+    if (buffered > 0)
+    {
+        size_t n = min(size, sizeof(buffer) - buffered);
+        memcpy(buffer + buffered, bytes, n);
+        buffered += n;
+        bytes += n;
+        size -= n;
+        if (buffered < sizeof(buffer))
+            return;
+        Compress(buffer);
+        buffered = 0;
+    }
+    for (; size >= 64; bytes += 64, size -= 64)
+        Compress(bytes);
+    memcpy(buffer, bytes, size);
+    buffered = size;
+}
+
+Sha256::Digest Sha256::Final()
+{
+    uint64_t bits = length * 8;
+    uint8_t padding[72] = { 0x80 };
+    size_t padSize = (buffered < 56 ? 56 : 120) - buffered;
+    for (int i = 0; i < 8; i++)
+        padding[padSize + i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+    Update(padding, padSize + 8);
+    Digest digest;
+    for (int i = 0; i < 8; i++)
+        for (int j = 0; j < 4; j++)
+            digest[4 * i + j] = static_cast<uint8_t>(state[i] >> (24 - 8 * j));
+    return digest;
+}
+
+string HexEncode(const uint8_t* data, size_t size)
+{
+    static const char DIGITS[] = "0123456789abcdef";
+    string out(size * 2, '0');
+    for (size_t i = 0; i < size; i++)
+    {
+        out[2 * i] = DIGITS[data[i] >> 4];
+        out[2 * i + 1] = DIGITS[data[i] & 15];
+    }
+    return out;
+}
+
+static int HexDigit(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool HexDecode(string_view text, vector<uint8_t>& out)
+{
+    out.clear();
+    if (text.size() % 2 != 0)
+        return false;
+    out.resize(text.size() / 2);
+    for (size_t i = 0; i < out.size(); i++)
+    {
+        int high = HexDigit(text[2 * i]), low = HexDigit(text[2 * i + 1]);
+        if (high < 0 || low < 0)
+            return false;
+        out[i] = static_cast<uint8_t>(high << 4 | low);
+    }
+    return true;
+}
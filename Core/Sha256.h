@@ -0,0 +1,38 @@
+// SHA-256（FIPS 180-4），供可验证抽取的承诺值使用；另附十六进制编解码
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Sha256
+{
+public:
+    using Digest = std::array<uint8_t, 32>;
+
+    void Update(const void* data, size_t size);
+    void Update(std::string_view text) { Update(text.data(), text.size()); }
+    Digest Final();
+
+    static Digest Hash(std::string_view text)
+    {
+        Sha256 sha;
+        sha.Update(text);
+        return sha.Final();
+    }
+
+private:
+    void Compress(const uint8_t* block);
+
+    uint32_t state[8] = { 0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19 };
+    uint64_t length = 0;      // 已输入的字节数
+    uint8_t buffer[64];
+    size_t buffered = 0;
+};
+
+// 小写十六进制；解码时长度为奇数或含非十六进制字符返回 false
+std::string HexEncode(const uint8_t* data, size_t size);
+bool HexDecode(std::string_view text, std::vector<uint8_t>& out);
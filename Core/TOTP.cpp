@@ -1,10 +1,16 @@
 // Using for generate and verify TOTP Code
 
 #include "pch.h"
+#include "TOTP.h"
+#include "Encoding.h"
+#include "Rng.h"
+#include "Trace.h"
+#include "Log.h"
+#include "Metrics.h"
 using namespace std;
 
 
-static string Base32Encode(const vector<uint8_t>& data) {
+string Base32Encode(const vector<uint8_t>& data) {
     static const char* ALPH = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
     string out;
     int bits = 0;
@@ -23,7 +29,7 @@ static string Base32Encode(const vector<uint8_t>& data) {
     return out;
 }
 
-static string UrlEncode(const string& s) {
+string UrlEncode(const string& s) {
     ostringstream oss;
     for (unsigned char c : s) {
         if ((c >= 'A' && c <= 'Z') ||
@@ -41,6 +47,94 @@ static string UrlEncode(const string& s) {
     return oss.str();
 }
 
+bool Base32Decode(string_view text, vector<uint8_t>& out) {
+    out.clear();
+    out.reserve(text.size() * 5 / 8);
+    uint32_t buffer = 0;
+    int bits = 0;
+    for (char ch : text) {
+        int v;
+        if (ch >= 'A' && ch <= 'Z') v = ch - 'A';
+        else if (ch >= 'a' && ch <= 'z') v = ch - 'a';
+        else if (ch >= '2' && ch <= '7') v = ch - '2' + 26;
+        else if (ch == '=' || ch == ' ' || ch == '-') continue; // 填充符与验证器应用显示时插入的分隔符
+        else return false;
+        buffer = (buffer << 5) | uint32_t(v);
+        bits += 5;
+        if (bits >= 8) {
+            out.push_back(uint8_t((buffer >> (bits - 8)) & 0xFF));
+            bits -= 8;
+        }
+    }
+    return true;
+}
+
+static int HexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+bool UrlDecode(string_view s, string& out) {
+    out.clear();
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '%') {
+            if (i + 2 >= s.size()) return false;
+            int hi = HexValue(s[i + 1]), lo = HexValue(s[i + 2]);
+            if (hi < 0 || lo < 0) return false;
+            out.push_back(char((hi << 4) | lo));
+            i += 2;
+        }
+        else if (s[i] == '+') out.push_back(' ');
+        else out.push_back(s[i]);
+    }
+    return true;
+}
+
+// 解析 otpauth://totp/<label>?secret=...&issuer=...&algorithm=...&digits=...&period=...
+bool ParseOtpauthUrl(string_view url, OtpauthUrl& result) {
+    result = OtpauthUrl();
+    constexpr string_view scheme = "otpauth://";
+    if (url.substr(0, scheme.size()) != scheme) return false;
+    url.remove_prefix(scheme.size());
+
+    size_t slash = url.find('/');
+    if (slash == string_view::npos) return false;
+    result.type = string(url.substr(0, slash));
+    if (result.type != "totp" && result.type != "hotp") return false;
+    url.remove_prefix(slash + 1);
+
+    size_t query = url.find('?');
+    if (!UrlDecode(url.substr(0, query), result.label)) return false;
+    if (query == string_view::npos) return false;
+    string_view params = url.substr(query + 1);
+
+    bool hasSecret = false;
+    string value;
+    while (!params.empty()) {
+        size_t amp = params.find('&');
+        string_view pair = params.substr(0, amp);
+        params = amp == string_view::npos ? string_view() : params.substr(amp + 1);
+        size_t eq = pair.find('=');
+        if (eq == string_view::npos) continue;
+        string_view key = pair.substr(0, eq);
+        if (!UrlDecode(pair.substr(eq + 1), value)) return false;
+        if (key == "secret") {
+            if (!Base32Decode(value, result.secret) || result.secret.empty()) return false;
+            hasSecret = true;
+        }
+        else if (key == "issuer") result.issuer = value;
+        else if (key == "algorithm") result.algorithm = value;
+        else if (key == "digits" || key == "period") {
+            if (value.empty() || value.size() > 3 || value.find_first_not_of("0123456789") != string::npos) return false;
+            (key == "digits" ? result.digits : result.period) = stoi(value);
+        }
+    }
+    return hasSecret && result.digits >= 6 && result.digits <= 8 && result.period > 0;
+}
+
 struct Sha1 {
     uint32_t h0 = 0x67452301, h1 = 0xEFCDAB89, h2 = 0x98BADCFE, h3 = 0x10325476, h4 = 0xC3D2E1F0;
     uint64_t total_bits = 0;
@@ -82,11 +176,12 @@ struct Sha1 {
     }
 
     vector<uint8_t> finalize() {
+        uint64_t message_bits = total_bits; // 填充前的消息长度，update 会继续累加 total_bits
         uint8_t pad[64] = { 0x80 };
         size_t pad_len = (buf_len < 56) ? (56 - buf_len) : (56 + 64 - buf_len);
         update(pad, pad_len);
         uint8_t len_bytes[8];
-        for (int i = 0; i < 8; ++i) len_bytes[7 - i] = uint8_t((total_bits >> (8 * i)) & 0xFF);
+        for (int i = 0; i < 8; ++i) len_bytes[7 - i] = uint8_t((message_bits >> (8 * i)) & 0xFF);
         update(len_bytes, 8);
         vector<uint8_t> out(20);
         uint32_t hs[5] = { h0,h1,h2,h3,h4 };
@@ -100,7 +195,7 @@ struct Sha1 {
     }
 };
 
-static void HmacSha1(const uint8_t* key, size_t key_len, const uint8_t* msg, size_t msg_len, uint8_t out[20]) {
+void HmacSha1(const uint8_t* key, size_t key_len, const uint8_t* msg, size_t msg_len, uint8_t out[20]) {
     uint8_t k0[64]; memset(k0, 0, 64);
     if (key_len > 64) {
         Sha1 s; s.update(key, key_len);
@@ -119,7 +214,7 @@ static void HmacSha1(const uint8_t* key, size_t key_len, const uint8_t* msg, siz
     memcpy(out, mac.data(), 20);
 }
 
-static string HotpCode(const uint8_t* key, size_t key_len, uint64_t counter, int digits) {
+string HotpCode(const uint8_t* key, size_t key_len, uint64_t counter, int digits) {
     uint8_t msg[8];
     for (int i = 7; i >= 0; --i) { msg[i] = uint8_t(counter & 0xFF); counter >>= 8; }
     uint8_t mac[20]; HmacSha1(key, key_len, msg, 8, mac);
@@ -137,13 +232,10 @@ static string HotpCode(const uint8_t* key, size_t key_len, uint64_t counter, int
 
 EXPORT_DLL BSTR CreateTOTPUrl() 
 {
-	wcout << L"IslandCaller.Core | Info | Start create TOTP secret and url\n";
-    std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter; // UTF-8 => UTF-16
-    constexpr LPCWSTR REG_PATH = L"SOFTWARE\\IslandCaller\\Security\\SecretKey";
-    constexpr LPCWSTR REG_VALUE = L"TOTPKey";
+    IC_LOG(LogLevel::Info, LogEvent::TotpCreateStart);
+    Metrics::Add(Counter::TotpCreateCalls);
     vector<uint8_t> secret(20);
-    random_device rd;
-    for (auto& b : secret) b = static_cast<uint8_t>(rd());
+    Rng::SecureBytes(secret.data(), secret.size()); // ChaCha20 安全流
     // 固定参数
     const string issuer = "IslandCaller";
     const string account = "Administrator";
@@ -160,63 +252,30 @@ EXPORT_DLL BSTR CreateTOTPUrl()
         << "&digits=" << digits
         << "&period=" << period;
    
-    HKEY hKey;
-    LONG res = RegCreateKeyExW(HKEY_CURRENT_USER, REG_PATH, 0, NULL,
-        REG_OPTION_NON_VOLATILE, KEY_WRITE, NULL, &hKey, NULL);
-    if (res != ERROR_SUCCESS) {
-        wcout << "IslandCaller.Core | Error | RegCreateKeyEx failed: " << res << "\n";
-        return SysAllocString(converter.from_bytes("").c_str());
-    }
-
-    res = RegSetValueExW(hKey, REG_VALUE, 0, REG_BINARY,
-        reinterpret_cast<const BYTE*>(secret.data()),
-        static_cast<DWORD>(secret.size()));
-    RegCloseKey(hKey);
-
-    if (res != ERROR_SUCCESS) {
-        std::cerr << "IslandCaller.Core | Error | RegSetValueEx failed: " << res << "\n";
-        return SysAllocString(converter.from_bytes("").c_str());
+    long res = Platform::WriteSecret(TOTP_SECRET_NAME, secret);
+    if (res != 0) {
+        IC_LOG(LogLevel::Error, LogEvent::TotpWriteSecretFailed, res);
+        Metrics::Add(Counter::TotpCreateErrors);
+        return Platform::AllocString("");
     }
-	wcout << L"IslandCaller.Core | Success | TOTP secret and url created successfully\n";
-	wcout << L"IslandCaller.Core | Info | TOTP URL: " << converter.from_bytes(oss.str()) << L"\n";
-    wcout << L"IslandCaller.Core | Debug | Secret (Base32): " << converter.from_bytes(secret_b32) << L"\n";
-    wcout << L"IslandCaller.Core | Debug | Secret (Hex): ";
-    for (auto b : secret) wcout << hex << setw(2) << setfill(L'0') << int(b);
-    wcout << endl;
-    return SysAllocString(converter.from_bytes(oss.str()).c_str());
+    IC_LOG(LogLevel::Info, LogEvent::TotpCreated);
+    // URL 与密钥只记录长度，内容一律脱敏
+    IC_LOG(LogLevel::Debug, LogEvent::TotpUrlIssued, Redact(secret_b32), secret.size());
+    return Platform::AllocString(oss.str());
 }
 
 EXPORT_DLL bool VerifyTOTP(const wchar_t* user_code)
 {
-	wcout << L"IslandCaller.Core | Info | Start verify TOTP code\n";
-    wstring_convert<codecvt_utf8<wchar_t>> conv;
-    string usercode_utf8 = conv.to_bytes(user_code);
-    wcout << L"IslandCaller.Core | Info | User provided code: " << user_code << L"\n";
-    constexpr LPCWSTR REG_PATH = L"SOFTWARE\\IslandCaller\\Security\\SecretKey";
-    constexpr LPCWSTR REG_VALUE = L"TOTPKey";
-
-    HKEY hKey;
-    LONG res = RegOpenKeyExW(HKEY_CURRENT_USER, REG_PATH, 0, KEY_READ, &hKey);
-    if (res != ERROR_SUCCESS) {
-		wcout << L"IslandCaller.Core | Error | RegOpenKeyEx failed: " << res << L"\n";
-		return false;
-    }
-
-    DWORD type = 0;
-    DWORD dataSize = 0;
-    res = RegGetValueW(hKey, NULL, REG_VALUE, RRF_RT_REG_BINARY, &type, NULL, &dataSize);
-    if (res != ERROR_SUCCESS || type != REG_BINARY) {
-        RegCloseKey(hKey);
-		wcout << L"IslandCaller.Core | Error | RegGetValue size query failed or wrong type: " << res << L"\n";
-		return false;
-    }
-
-    std::vector<uint8_t> secret(dataSize);
-    res = RegGetValueW(hKey, NULL, REG_VALUE, RRF_RT_REG_BINARY, NULL, secret.data(), &dataSize);
-    RegCloseKey(hKey);
+    IC_TRACE_SPAN(TraceOp::Verify);
+    string usercode_utf8 = WideToUtf8(user_code);
+    IC_LOG(LogLevel::Info, LogEvent::TotpVerifyStart, Redact(usercode_utf8), usercode_utf8.size());
+    Metrics::Add(Counter::TotpVerifyCalls);
 
-    if (res != ERROR_SUCCESS) {
-		wcout << L"IslandCaller.Core | Error | RegGetValue data read failed: " << res << L"\n";
+    std::vector<uint8_t> secret;
+    long res = Platform::ReadSecret(TOTP_SECRET_NAME, secret);
+    if (res != 0) {
+        IC_LOG(LogLevel::Error, LogEvent::TotpReadSecretFailed, res);
+        Metrics::Add(Counter::TotpVerifyErrors);
 		return false;
     }
 
@@ -233,12 +292,13 @@ EXPORT_DLL bool VerifyTOTP(const wchar_t* user_code)
         int64_t c = int64_t(counter) + delta;
         if (c < 0) continue;
         string code = HotpCode(secret.data(), secret.size(), uint64_t(c), digits);
-        wcout << L"IslandCaller.Core | Info | Generated code for counter " << c << L": " << conv.from_bytes(code) << L"\n";
+        IC_LOG(LogLevel::Debug, LogEvent::TotpCodeChecked, c, Redact(code));
         if (code == usercode_utf8) {
-            wcout << L"IslandCaller.Core | Success | TOTP code verified successfully\n";
+            IC_LOG(LogLevel::Info, LogEvent::TotpVerified);
             return true;
         }
     }
-	wcout << L"IslandCaller.Core | Failed | TOTP code wrong\n";
+    IC_LOG(LogLevel::Info, LogEvent::TotpWrongCode);
+    Metrics::Add(Counter::TotpVerifyRejected);
     return false;
 }
@@ -0,0 +1,32 @@
+// TOTP 内部函数，供测试与基准测试直接调用
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 密钥存储中 TOTP 密钥的名称
+constexpr const wchar_t* TOTP_SECRET_NAME = L"TOTPKey";
+
+std::string Base32Encode(const std::vector<uint8_t>& data);
+std::string UrlEncode(const std::string& s);
+void HmacSha1(const uint8_t* key, size_t key_len, const uint8_t* msg, size_t msg_len, uint8_t out[20]);
+std::string HotpCode(const uint8_t* key, size_t key_len, uint64_t counter, int digits);
+
+// 解析方向：Base32 解码（忽略大小写、填充符与空格），URL 百分号解码，以及 otpauth URL 解析
+struct OtpauthUrl
+{
+    std::string type;                 // totp / hotp
+    std::string label;                // 已解码的 issuer:account
+    std::vector<uint8_t> secret;
+    std::string issuer;
+    std::string algorithm = "SHA1";
+    int digits = 6;
+    int period = 30;
+};
+
+bool Base32Decode(std::string_view text, std::vector<uint8_t>& out);
+bool UrlDecode(std::string_view s, std::string& out);
+bool ParseOtpauthUrl(std::string_view url, OtpauthUrl& result);
@@ -0,0 +1,1069 @@
+// Core 单元测试：在临时的 ISLANDCALLER_HOME 下导入名单、抽取、生成并验证 TOTP
+// 无第三方依赖，失败时返回非零退出码供 ctest 判定
+
+#include "Exports.h"
+#include "TOTP.h"
+#include "Encoding.h"
+#include "RosterParser.h"
+#include "Log.h"
+#include "Metrics.h"
+#include "IpcServer.h"
+#include "RandomEngine.h"
+#include "EntropyPool.h"
+#include "RosterAlgebra.h"
+#include "Sha256.h"
+#include "VerifiableSession.h"
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <numeric>
+#include <set>
+#include <thread>
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+static int failures = 0;
+
+#define CHECK(expr) \
+    do { if (!(expr)) { cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #expr "\n"; ++failures; } } while (0)
+
+static string testHome;
+
+static void SetupHome()
+{
+#ifdef _WIN32
+    char buffer[MAX_PATH];
+    GetTempPathA(MAX_PATH, buffer);
+    testHome = string(buffer) + "IslandCallerTests";
+    CreateDirectoryA(testHome.c_str(), NULL);
+    CreateDirectoryA((testHome + "\\Profile").c_str(), NULL);
+    _putenv_s("ISLANDCALLER_HOME", testHome.c_str());
+#else
+    char templ[] = "/tmp/ic_core_tests.XXXXXX";
+    testHome = mkdtemp(templ);
+    setenv("ISLANDCALLER_HOME", testHome.c_str(), 1);
+    system(("mkdir -p " + testHome + "/Profile").c_str());
+#endif
+}
+
+static void WriteProfile(const string& name, const string& content)
+{
+    ofstream file(Platform::GetProfilePath(name + ".csv"), ios::binary);
+    file << content;
+}
+
+// 把导出函数返回的 BSTR 转为 UTF-8 并释放
+static string TakeString(BSTR str)
+{
+    string out = WideToUtf8(str);
+    Platform::FreeString(str);
+    return out;
+}
+
+static vector<string> Split(const string& s, string_view separator = "  ")
+{
+    vector<string> out;
+    size_t start = 0;
+    while (true)
+    {
+        size_t pos = s.find(separator, start);
+        out.push_back(s.substr(start, pos - start));
+        if (pos == string::npos) break;
+        start = pos + separator.size();
+    }
+    return out;
+}
+
+static void TestImportParsing()
+{
+    WriteProfile("Parsing", "ID,Name,Gender\n1,\"小明\",0\n2,  李华 ,1\r\n3,\"小明\",0\n4,,0\n5,Tom,1\n");
+    CHECK(RandomImport(L"Parsing") == 0);
+    set<string> seen;
+    for (int i = 0; i < 3; i++)
+        seen.insert(TakeString(SimpleRandom(1)));
+    CHECK(seen == (set<string>{ "小明", "李华", "Tom" }));
+}
+
+static void TestCsvQuoting()
+{
+    // Excel 导出：BOM、CRLF、含逗号与转义双引号的引号字段、未闭合的引号、多余的空列
+    string csv = "\xEF\xBB\xBFID,Name,Gender\r\n"
+        "1,\"Zhang, San\",0\r\n"
+        "2,\"Li \"\"Xiao\"\" Hua\",1\r\n"
+        "3, \"  Wang \" ,0,,\r\n"
+        "4,\"Zhao\r\n"
+        "5\r\n";
+    vector<string> names;
+    ParseRoster(csv, names);
+    CHECK(names == (vector<string>{ "Zhang, San", "Li \"Xiao\" Hua", "Wang", "Zhao" }));
+
+    // 非法 UTF-8 不应导致抛出异常，而是替换为 U+FFFD
+    WriteProfile("Invalid", "ID,Name,Gender\n1,\xC0\xAF\xFF,0\n");
+    CHECK(RandomImport(L"Invalid") == 0);
+    CHECK(TakeString(SimpleRandom(1)) == "\xEF\xBF\xBD\xEF\xBF\xBD\xEF\xBF\xBD");
+    CHECK(!IsValidUtf8("\xED\xA0\x80"));
+    CHECK(IsValidUtf8("小明\xF0\x9F\x98\x80"));
+    CHECK(WideToUtf8(Utf8ToWide("小明\xF0\x9F\x98\x80")) == "小明\xF0\x9F\x98\x80");
+}
+
+static void TestImportFailures()
+{
+    CHECK(RandomImport(L"DoesNotExist") == -1);
+    WriteProfile("Empty", "ID,Name,Gender\n1,,0\n");
+    CHECK(RandomImport(L"Empty") == -1);
+}
+
+static void TestNoRepeatUntilCycle()
+{
+    string csv = "ID,Name,Gender\n";
+    for (int i = 0; i < 10; i++)
+        csv += to_string(i) + ",S" + to_string(i) + ",0\n";
+    WriteProfile("Cycle", csv);
+    CHECK(RandomImport(L"Cycle") == 0);
+
+    vector<string> first = Split(TakeString(SimpleRandom(4)));
+    vector<string> second = Split(TakeString(SimpleRandom(6)));
+    set<string> all(first.begin(), first.end());
+    all.insert(second.begin(), second.end());
+    CHECK(first.size() == 4);
+    CHECK(second.size() == 6);
+    CHECK(all.size() == 10);
+
+    // 全部抽完后自动开始新一轮
+    CHECK(Split(TakeString(SimpleRandom(10))).size() == 10);
+    CHECK(TakeString(SimpleRandom(11)) == "Not enough students!");
+
+    // 清空历史后可以一次抽满
+    TakeString(SimpleRandom(3));
+    ClearHistory();
+    vector<string> full = Split(TakeString(SimpleRandom(10)));
+    CHECK(set<string>(full.begin(), full.end()).size() == 10);
+}
+
+static void TestRecentlyDrawn()
+{
+    WriteProfile("Recent", "ID,Name\n1,A\n2,B\n3,C\n4,D\n5,E\n");
+    CHECK(RandomImport(L"Recent") == 0);
+    CHECK(TakeString(RecentlyDrawn(1)).empty());
+
+    string first = TakeString(SimpleRandom(1));
+    ClearHistory();
+    string second = TakeString(SimpleRandom(1));
+    ClearHistory();
+    ClearHistory();
+    CHECK(TakeString(RecentlyDrawn(1)).empty());
+    CHECK(TakeString(RecentlyDrawn(2)).empty());
+    CHECK(TakeString(RecentlyDrawn(3)) == second);
+    vector<string> both = Split(TakeString(RecentlyDrawn(4)));
+    CHECK(set<string>(both.begin(), both.end()) == set<string>({ first, second }) || (first == second && both.size() == 1));
+
+    // 清空历史只推进轮次，本轮仍可以抽满；重新导入后轮次记录清零
+    CHECK(Split(TakeString(SimpleRandom(5))).size() == 5);
+    CHECK(Split(TakeString(RecentlyDrawn(1))).size() == 5);
+    CHECK(RandomImport(L"Recent") == 0);
+    CHECK(TakeString(RecentlyDrawn(100)).empty());
+}
+
+static void TestStratified()
+{
+    string csv = "ID,Name,Group\n";
+    for (int i = 0; i < 12; i++)
+        csv += to_string(i) + ",S" + to_string(i) + ",G" + to_string(i < 6 ? 0 : i < 9 ? 1 : 2) + "\n";
+    WriteProfile("Groups", csv);
+    CHECK(RandomImportGrouped(L"Groups", L"Missing") == -1);
+    CHECK(RandomImportGrouped(L"Groups", L"Group") == 0);
+    auto groupOf = [](const string& name) { int i = stoi(name.substr(1)); return i < 6 ? 0 : i < 9 ? 1 : 2; };
+
+    // 每组一人，按组的先后输出；连抽三次后 G1、G2 已抽完，第四次这两组在全组中重抽
+    set<string> seen;
+    for (int round = 0; round < 4; round++)
+    {
+        vector<string> picked = Split(TakeString(StratifiedRandom(0, 0)));
+        CHECK(picked.size() == 3);
+        for (size_t g = 0; g < picked.size() && g < 3; g++)
+            CHECK(groupOf(picked[g]) == static_cast<int>(g));
+        if (round < 3) seen.insert(picked.begin(), picked.end());
+        else CHECK(seen.count(picked[0]) == 0);
+    }
+    CHECK(seen.size() == 9);
+
+    // 按比例：剩余 6:3:3 时抽 4 人为 2:1:1
+    ClearHistory();
+    vector<int> counts(3);
+    vector<string> picked = Split(TakeString(StratifiedRandom(1, 4)));
+    for (const string& name : picked)
+        counts[groupOf(name)]++;
+    CHECK(counts == (vector<int>{ 2, 1, 1 }));
+    CHECK(TakeString(StratifiedRandom(1, 9)) == "Not enough available students!");
+    CHECK(Split(TakeString(StratifiedRandom(1, 8))).size() == 8);
+
+    // 未分组导入的名单只有一组
+    CHECK(RandomImport(L"Groups") == 0);
+    CHECK(Split(TakeString(StratifiedRandom(0, 0))).size() == 1);
+
+    // 导入失败（文件不存在、缺列、名单为空）后不保留旧名单的分组，分层抽取报告尚未导入
+    RandomEngine engine;
+    vector<int> indices;
+    for (const char* path : { "DoesNotExist.csv", "Empty.csv" })
+    {
+        engine.Load({ "A", "B", "C" }, { "x", "y", "z" });
+        CHECK(engine.Import(Platform::GetProfilePath(path)) == -1);
+        CHECK(engine.Size() == 0 && !engine.IsInitialized());
+        CHECK(engine.DrawStratified(StratifyMode::OnePerGroup, 0, indices) == DrawStatus::NotInitialized);
+    }
+    CHECK(RandomImportGrouped(L"Groups", L"Group") == 0);
+    CHECK(RandomImportGrouped(L"Groups", L"Missing") == -1);
+    CHECK(TakeString(StratifiedRandom(0, 0)) == "Not Initialized!");
+}
+
+static void TestSeating()
+{
+    // 4 行 5 列，姓名即座位，如 R2C3；最多只能选出 6 个两两不相邻（含斜对角）的座位
+    string csv = "ID,Name,Row,Col\n";
+    for (int r = 1; r <= 4; r++)
+        for (int c = 1; c <= 5; c++)
+            csv += "0,R" + to_string(r) + "C" + to_string(c) + "," + to_string(r) + "," + to_string(c) + "\n";
+    WriteProfile("Seats", csv);
+    CHECK(RandomImportColumns(L"Seats", nullptr, L"Row", L"Missing") == -1);
+    CHECK(RandomImportColumns(L"Seats", nullptr, L"Row", L"Col") == 0);
+    auto seat = [](const string& name) { return make_pair(name[1] - '0', name[3] - '0'); };
+    auto adjacent = [&](const string& a, const string& b) {
+        return abs(seat(a).first - seat(b).first) <= 1 && abs(seat(a).second - seat(b).second) <= 1;
+    };
+
+    for (int i = 0; i < 20; i++)
+    {
+        ClearHistory();
+        vector<string> picked = Split(TakeString(SpatialRandom(0, 4)));
+        CHECK(picked.size() == 4);
+        for (size_t a = 0; a < picked.size(); a++)
+            for (size_t b = a + 1; b < picked.size(); b++)
+                CHECK(!adjacent(picked[a], picked[b]));
+    }
+    ClearHistory();
+    CHECK(TakeString(SpatialRandom(0, 7)) == "Not enough available students!");
+    CHECK(Split(TakeString(SimpleRandom(20))).size() == 20); // 失败的抽取不留下历史
+
+    // 中心在前，其后是周围所有同学：角上 3 人、边上 5 人、中间 8 人
+    for (int i = 0; i < 20; i++)
+    {
+        vector<string> cluster = Split(TakeString(SpatialRandom(1, 0)));
+        auto [row, col] = seat(cluster[0]);
+        size_t expected = (row == 1 || row == 4 ? 2 : 3) * (col == 1 || col == 5 ? 2 : 3);
+        CHECK(cluster.size() == expected);
+        for (size_t j = 1; j < cluster.size(); j++)
+            CHECK(adjacent(cluster[0], cluster[j]) && cluster[j] != cluster[0]);
+    }
+
+    CHECK(RandomImport(L"Seats") == 0);
+    CHECK(TakeString(SpatialRandom(1, 0)) == "No seating chart!");
+    WriteProfile("Sparse", "ID,Name,Row,Col\n1,A,1,1\n2,B,100000,100000\n");
+    CHECK(RandomImportColumns(L"Sparse", nullptr, L"Row", L"Col") == -1);
+
+    // 导入失败后不保留旧名单的座位表：按座位抽取报告尚未导入，而不是在空名单上抽取
+    for (const wchar_t* profile : { L"Sparse", L"DoesNotExist" })
+    {
+        CHECK(RandomImportColumns(L"Seats", nullptr, L"Row", L"Col") == 0);
+        CHECK(RandomImportColumns(profile, nullptr, L"Row", L"Col") == -1);
+        CHECK(TakeString(SpatialRandom(0, 2)) == "Not Initialized!");
+        CHECK(TakeString(SpatialRandom(1, 0)) == "Not Initialized!");
+    }
+    CHECK(RandomImportColumns(L"Seats", nullptr, L"Row", L"Col") == 0);
+    CHECK(RandomImportColumns(L"Seats", nullptr, L"Row", L"Missing") == -1);
+    CHECK(TakeString(SpatialRandom(1, 0)) == "Not Initialized!");
+}
+
+static void TestUndo()
+{
+    WriteProfile("Undo", "ID,Name\n1,A\n2,B\n3,C\n4,D\n");
+    CHECK(RandomImport(L"Undo") == 0);
+    CHECK(TakeString(UndoDraw()) == "Nothing to undo!");
+    Metrics::Snapshot before = Metrics::Take();
+
+    // 撤销放回被抽中的学生，重做原样抽中同一批
+    vector<string> first = Split(TakeString(SimpleRandom(3)));
+    vector<string> undone = Split(TakeString(UndoDraw()));
+    CHECK(undone == first);
+    CHECK(TakeString(RecentlyDrawn(1)).empty());
+    CHECK(Split(TakeString(RedoDraw())) == first);
+    CHECK(Split(TakeString(RecentlyDrawn(1))).size() == 3);
+
+    // 抽满后的下一次抽取先自动清空：撤销恢复到上一轮抽满的状态；再撤销一次则只剩最后一人可抽
+    string fourth = TakeString(SimpleRandom(1));
+    CHECK(Split(TakeString(SimpleRandom(2))).size() == 2);
+    CHECK(Split(TakeString(UndoDraw())).size() == 2);
+    CHECK(Split(TakeString(RecentlyDrawn(1))).size() == 4);
+    CHECK(TakeString(UndoDraw()) == fourth);
+    CHECK(TakeString(SimpleRandom(1)) == fourth);
+    CHECK(TakeString(RedoDraw()) == "Nothing to redo!"); // 新的抽取使重做记录作废
+
+    // 撤销手动清空后历史完整恢复
+    ClearHistory();
+    CHECK(TakeString(RecentlyDrawn(1)).empty());
+    CHECK(TakeString(UndoDraw()).empty());
+    CHECK(Split(TakeString(RecentlyDrawn(1))).size() == 4);
+
+    // 记录数有上限，失败的抽取不入栈
+    TakeString(SimpleRandom(5));
+    int undos = 0;
+    for (int i = 0; i < 40; i++)
+        TakeString(SimpleRandom(1));
+    while (TakeString(UndoDraw()) != "Nothing to undo!")
+        undos++;
+    CHECK(undos == static_cast<int>(RandomEngine::UNDO_LIMIT));
+
+    Metrics::Snapshot after = Metrics::Take();
+    CHECK(after[Counter::DrawsUndone] - before[Counter::DrawsUndone] == 4 + RandomEngine::UNDO_LIMIT);
+    CHECK(after[Counter::DrawsRedone] - before[Counter::DrawsRedone] == 1);
+    CHECK(after[Gauge::UndoDepth] == 0);
+}
+
+static void TestCooldown()
+{
+    RandomEngine engine;
+    engine.Load({ "A", "B", "C", "D", "E" });
+    engine.SetCooldown(3);
+    RandomStream gen(11);
+    vector<int> picked, recent;
+    // 每 5 次恰好抽完一轮，且任意一次都不是最近 3 次中抽到的人（跨轮次）
+    for (int i = 0; i < 200; i++)
+    {
+        CHECK(engine.Draw(1, picked, gen) == DrawStatus::Ok);
+        CHECK(find(recent.end() - min<size_t>(recent.size(), 3), recent.end(), picked[0]) == recent.end());
+        recent.push_back(picked[0]);
+        if (recent.size() % 5 == 0)
+            CHECK(set<int>(recent.end() - 5, recent.end()).size() == 5);
+    }
+
+    // 撤销后冷却与历史都回到抽取前：与未抽取的副本用同样的随机数得到同样的结果
+    RandomEngine before = engine;
+    RandomStream replay = gen;
+    CHECK(engine.Draw(2, picked, gen) == DrawStatus::Ok);
+    CHECK(engine.Undo(picked));
+    vector<int> a, b;
+    RandomStream gen2 = replay;
+    engine.Draw(1, a, replay);
+    before.Draw(1, b, gen2);
+    CHECK(a == b);
+
+    // 冷却会导致人数不足时忽略冷却：6 人每次抽 3 人，新一轮只有 2 人不在冷却中，抽取照常完成
+    engine.Load({ "A", "B", "C", "D", "E", "F" });
+    engine.SetCooldown(4);
+    for (int i = 0; i < 20; i++)
+        CHECK(engine.Draw(3, picked, gen) == DrawStatus::Ok);
+}
+
+static void TestRandomStreams()
+{
+    // 与 xoshiro256** 参考实现对照：状态 {1, 2, 3, 4} 的前几个输出，以及 Jump、LongJump 之后的第一个输出
+    Xoshiro256 gen({ 1, 2, 3, 4 });
+    Xoshiro256 jumped = gen, longJumped = gen;
+    CHECK(gen() == 11520 && gen() == 0 && gen() == 1509978240 && gen() == 1215971899390074240ull);
+    jumped.Jump();
+    Xoshiro256 copy = jumped;
+    CHECK(jumped() == 0xBBD2F312298443D8ull);
+    copy.Jump();
+    CHECK(copy() == 0xE6FA17F037CA591Cull);
+    longJumped.LongJump();
+    CHECK(longJumped() == 0x527752A1D792704Dull);
+
+    // 分出的流各不相同；各线程的流互不相同且与名单句柄的流不同
+    RandomStream a = Rng::NewStream(), b = Rng::NewStream();
+    CHECK(a() != b());
+    uint64_t first[2] = {};
+    thread worker([&] { first[1] = Rng::ThreadStream()(); });
+    worker.join();
+    first[0] = Rng::ThreadStream()();
+    CHECK(first[0] != first[1] && first[0] != a() && first[1] != b());
+
+    // ChaCha20：全零密钥与 nonce 的第一块与 RFC 7539 的测试向量相同；跨越缓冲区边界后仍与参考实现一致
+    ChaCha20 zero({}, 0);
+    CHECK(zero() == 0x903DF1A0ADE0B876ull && zero() == 0x28BD8653E56A5D40ull);
+    ChaCha20 keyed({ 1, 2, 3, 4, 5, 6, 7, 8 }, 7);
+    CHECK(keyed() == 0xA0A2D11B01B1EA41ull);
+    for (int i = 1; i < 64; i++) keyed();
+    CHECK(keyed() == 0x20BC4D46AFC34284ull);
+    uint8_t bytes[3];
+    keyed.Fill(bytes, sizeof(bytes));
+    CHECK(bytes[0] == 0x92 && bytes[1] == 0x56 && bytes[2] == 0x23);
+
+    // SecureBytes 取自当前线程的安全流，不另外维护一个生成器
+    RandomStream secureCopy = Rng::ThreadStream(RandomMode::Secure);
+    uint8_t expected[40], actual[40];
+    secureCopy.Fill(expected, sizeof(expected));
+    Rng::SecureBytes(actual, sizeof(actual));
+    CHECK(equal(begin(expected), end(expected), begin(actual)));
+
+    // 安全模式的名单照常抽完一轮
+    RandomEngine engine;
+    engine.Load({ "A", "B", "C", "D", "E", "F" });
+    engine.SetRandomMode(RandomMode::Secure);
+    vector<int> picked, all;
+    for (int i = 0; i < 3; i++)
+    {
+        CHECK(engine.Draw(2, picked) == DrawStatus::Ok);
+        all.insert(all.end(), picked.begin(), picked.end());
+    }
+    CHECK(set<int>(all.begin(), all.end()).size() == 6);
+}
+
+static void TestEntropyPool()
+{
+    // 跨越线程块与整批边界的取用都得到非零且互不相同的内容
+    vector<uint8_t> a(Entropy::BATCH + 100), b(a.size());
+    CHECK(Entropy::Fill(a.data(), a.size()) && Entropy::Fill(b.data(), b.size()));
+    CHECK(a != b && count(a.begin(), a.end(), 0) < 64);
+
+    // 1000 条安全流共需 32 KB 密钥，系统读取次数按整批计，远少于流的条数
+    uint64_t before = Metrics::Take()[Counter::EntropyRefills];
+    for (int i = 0; i < 1000; i++)
+        Rng::NewStream(RandomMode::Secure);
+    uint64_t refills = Metrics::Take()[Counter::EntropyRefills] - before;
+    CHECK(refills <= 1000 * 32 / Entropy::BATCH + 2);
+
+    // 其他线程同样可以取用
+    vector<uint8_t> c(64);
+    bool ok = false;
+    thread worker([&] { ok = Entropy::Fill(c.data(), c.size()); });
+    worker.join();
+    CHECK(ok && !equal(c.begin(), c.end(), a.begin()));
+}
+
+static void TestExclusions()
+{
+    // 60 人、200 对随机互斥约束，每次抽 5 人：全部成功且不含互斥的两人
+    RandomEngine engine;
+    vector<string> names(60);
+    for (size_t i = 0; i < names.size(); i++) names[i] = "S" + to_string(i);
+    engine.Load(names);
+    RandomStream gen(5);
+    while (engine.ExclusionCount() < 200)
+        engine.AddExclusion(static_cast<int>(gen() % 60), static_cast<int>(gen() % 60));
+    CHECK(!engine.AddExclusion(3, 3));
+    vector<int> picked;
+    for (int i = 0; i < 500; i++)
+    {
+        CHECK(engine.Draw(5, picked, gen) == DrawStatus::Ok);
+        for (size_t a = 0; a < picked.size(); a++)
+            for (size_t b = a + 1; b < picked.size(); b++)
+                CHECK(!engine.Excluded(picked[a], picked[b]));
+    }
+
+    // 顺序抽取会走入死路时回溯：A 与 B、C、D 互斥，抽 3 人只能是 B、C、D
+    engine.Load({ "A", "B", "C", "D" });
+    engine.AddExclusion(0, 1);
+    engine.AddExclusion(0, 2);
+    engine.AddExclusion(0, 3);
+    for (int i = 0; i < 20; i++)
+    {
+        engine.ClearHistory();
+        CHECK(engine.Draw(3, picked, gen) == DrawStatus::Ok);
+        CHECK(set<int>(picked.begin(), picked.end()) == (set<int>{ 1, 2, 3 }));
+    }
+
+    // 遵守冷却凑不出组合时忽略冷却，而不是返回 ExclusionConflict：A 与 B 互斥，冷却 2 人次
+    engine.Load({ "A", "B", "C", "D" });
+    engine.AddExclusion(0, 1);
+    for (int i = 0; i < 200; i++)
+    {
+        engine.SetCooldown(2);
+        CHECK(engine.Draw(2, picked, gen) == DrawStatus::Ok);
+        CHECK(engine.Draw(2, picked, gen) == DrawStatus::Ok); // 本轮剩下的可能是 A、B，新一轮中 C、D 在冷却
+        engine.ClearHistory();
+        CHECK(engine.Draw(2, picked, gen) == DrawStatus::Ok); // 冷却中的两人可能恰是唯一不与 A、B 冲突的两人
+        CHECK(!engine.Excluded(picked[0], picked[1]));
+        engine.ClearHistory();
+    }
+
+    // 确实无解时返回 ExclusionConflict，历史不变
+    WriteProfile("Exclusions", "ID,Name\n1,A\n2,B\n3,C\n");
+    CHECK(RandomImport(L"Exclusions") == 0);
+    CHECK(AddExclusion(L"A", L"B") == 0);
+    CHECK(AddExclusion(L"B", L"C") == 0);
+    CHECK(AddExclusion(L"A", L"Nobody") == -1);
+    CHECK(TakeString(SimpleRandom(3)) == "Exclusion constraints cannot be satisfied!");
+    vector<string> pair = Split(TakeString(SimpleRandom(2)));
+    CHECK(set<string>(pair.begin(), pair.end()) == (set<string>{ "A", "C" }));
+    ClearExclusions();
+    CHECK(Split(TakeString(SimpleRandom(1))).size() == 1);
+}
+
+static void TestAnimation()
+{
+    // 姓名中的连续空格原样保留，动画名单以换行分隔
+    WriteProfile("Animation", "ID,Name\n1,A  1\n2,B  2\n3,C  3\n4,D  4\n5,E  5\n6,F  6\n");
+    const set<string> roster = { "A  1", "B  2", "C  3", "D  4", "E  5", "F  6" };
+    CHECK(RandomImport(L"Animation") == 0);
+    const int frames = 12, number = 2;
+    vector<int> slots(frames * number), times(frames);
+    BSTR names = nullptr;
+    CHECK(AnimatedRandom(number, frames, 1000, slots.data(), times.data(), &names) == 0);
+    vector<string> arena = Split(TakeString(names), "\n");
+    CHECK(arena.size() >= number && set<string>(arena.begin(), arena.end()).size() == arena.size());
+    for (const string& name : arena)
+        CHECK(roster.count(name) == 1);
+    // RecentlyDrawn 按名单顺序列出，名单恰好按姓名排序
+    set<string> result(arena.begin(), arena.begin() + min<size_t>(number, arena.size()));
+    CHECK(TakeString(RecentlyDrawn(1)) == *result.begin() + "  " + *result.rbegin());
+    // 末帧为结果；每个位置与前一帧不同，同一帧内互不相同；下标都在动画名单内
+    CHECK(slots[(frames - 1) * number] == 0 && slots[(frames - 1) * number + 1] == 1);
+    for (int f = 0; f < frames; f++)
+    {
+        CHECK(slots[f * number] != slots[f * number + 1]);
+        for (int s = 0; s < number; s++)
+        {
+            CHECK(slots[f * number + s] >= 0 && slots[f * number + s] < static_cast<int>(arena.size()));
+            if (f > 0) CHECK(slots[f * number + s] != slots[(f - 1) * number + s]);
+        }
+    }
+    // 缓出：从 0 开始到 durationMs 结束，间隔逐渐变长
+    CHECK(times.front() == 0 && times.back() == 1000);
+    for (int f = 2; f < frames; f++)
+        CHECK(times[f] - times[f - 1] >= times[f - 1] - times[f - 2] - 1);
+
+    CHECK(AnimatedRandom(7, frames, 1000, slots.data(), times.data(), &names) == -1);
+    CHECK(TakeString(names) == "Not enough students!");
+
+    // 全员抽取时同一帧内无法互不相同，但每个位置仍与前一帧不同，且不靠重试碰运气
+    WriteProfile("AnimationAll", "ID,Name\n1,A\n2,B\n3,C\n");
+    CHECK(RandomImport(L"AnimationAll") == 0);
+    const int longFrames = 64;
+    slots.assign(longFrames * 3, -1);
+    times.assign(longFrames, 0);
+    for (int round = 0; round < 20; round++)
+    {
+        CHECK(AnimatedRandom(3, longFrames, 1000, slots.data(), times.data(), &names) == 0);
+        TakeString(names);
+        for (int f = 1; f < longFrames; f++)
+            for (int s = 0; s < 3; s++)
+                CHECK(slots[f * 3 + s] != slots[(f - 1) * 3 + s]);
+    }
+}
+
+static void TestState()
+{
+    WriteProfile("State", "ID,Name\n1,A\n2,B\n3,C\n4,D\n5,E\n");
+    WriteProfile("StateOther", "ID,Name\n1,A\n2,B\n3,C\n4,D\n5,F\n");
+    CHECK(RandomImport(L"State") == 0);
+    TakeString(SimpleRandom(3));
+    vector<string> drawn = Split(TakeString(RecentlyDrawn(1)));
+    vector<uint8_t> state(SaveState(nullptr, 0));
+    CHECK(SaveState(state.data(), static_cast<int>(state.size())) == static_cast<int>(state.size()));
+
+    // 之后的改动在恢复后全部回到快照时的状态
+    ClearHistory();
+    TakeString(SimpleRandom(4));
+    CHECK(LoadState(state.data(), static_cast<int>(state.size())) == 0);
+    CHECK(Split(TakeString(RecentlyDrawn(1))) == drawn);
+    // 撤销记录随快照恢复：快照之前的抽取仍可撤销、重做
+    CHECK(Split(TakeString(UndoDraw())).size() == 3);
+    CHECK(Split(TakeString(RedoDraw())).size() == 3);
+    CHECK(TakeString(SimpleRandom(3)) == "Not enough available students!");
+    CHECK(Split(TakeString(SimpleRandom(2))).size() == 2);
+    CHECK(TakeString(UndoDraw()) != "Nothing to undo!");
+
+    // 损坏、截断或不属于当前名单的快照被拒绝，原状态不变
+    vector<uint8_t> corrupted = state;
+    corrupted[40] ^= 1;
+    CHECK(LoadState(corrupted.data(), static_cast<int>(corrupted.size())) == -2);
+    CHECK(LoadState(state.data(), static_cast<int>(state.size()) - 1) == -2);
+    CHECK(RandomImport(L"StateOther") == 0);
+    CHECK(LoadState(state.data(), static_cast<int>(state.size())) == -3);
+    CHECK(TakeString(RecentlyDrawn(1)).empty());
+
+    // 冷却记录同样随快照恢复，恢复时不清空
+    RandomEngine engine;
+    CHECK(engine.Import(Platform::GetProfilePath("State.csv")) == 0);
+    engine.SetCooldown(3);
+    RandomStream gen(7);
+    vector<int> picked, cooled;
+    CHECK(engine.Draw(3, picked, gen) == DrawStatus::Ok);
+    string snapshot;
+    engine.SaveState(snapshot);
+    engine.SetCooldown(0);
+    CHECK(engine.LoadState(snapshot) == RandomEngine::StateError::Ok);
+    CHECK(engine.Cooldown() == 3 && engine.UndoDepth() == 1);
+    engine.ClearHistory();
+    CHECK(engine.Draw(2, cooled, gen) == DrawStatus::Ok);
+    for (int index : cooled)
+        CHECK(find(picked.begin(), picked.end(), index) == picked.end());
+}
+
+// 固定种子与名单（见 TestVerifiableSession 末尾）录制的记录，改动取整或抽取算法时会失配
+static const char PINNED_TRANSCRIPT[] =
+    "islandcaller-transcript 3\n"
+    "commitment 894452de218398def4bc129b2afb7dff2ed55d6cfa22c4fbb8bde6dbf1a0e303\n"
+    "seed 000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f\n"
+    "state 49435354030000000800000003000000d9b424d3128e27bb0100000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000c000000000000000000000000000000f0b5845f\n"
+    "exclusions\n"
+    "draw 3 = 3 2 6\n"
+    "stratified 1 4 = 0 4 5 7\n"
+    "draw 1 = 1\n"
+    "draw 2 = 2 1\n"
+    "end\n";
+
+static void TestVerifiableSession()
+{
+    // SHA-256 标准测试向量与十六进制编解码
+    auto hash = [](string_view text) { Sha256::Digest d = Sha256::Hash(text); return HexEncode(d.data(), d.size()); };
+    CHECK(hash("abc") == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    CHECK(hash("") == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    CHECK(hash("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq") ==
+        "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    vector<uint8_t> bytes;
+    CHECK(HexDecode("00ff7A", bytes) && bytes == (vector<uint8_t>{ 0x00, 0xFF, 0x7A }));
+    CHECK(!HexDecode("abc", bytes) && !HexDecode("zz", bytes));
+
+    // 一节课：开始时公布承诺值，课上各种抽取、撤销与清空，下课揭示记录
+    WriteProfile("Session", "ID,Name,Group\n1,A,g1\n2,B,g1\n3,C,g2\n4,D,g2\n5,E,g3\n6,F,g3\n7,G,g3\n");
+    CHECK(RandomImportGrouped(L"Session", L"Group") == 0);
+    CHECK(TakeString(EndVerifiableSession()).empty());
+    SetCooldown(3);
+    TakeString(SimpleRandom(2));
+    string commitment = TakeString(BeginVerifiableSession());
+    CHECK(commitment.size() == 64);
+    TakeString(SimpleRandom(2));
+    TakeString(StratifiedRandom(0, 0));
+    TakeString(UndoDraw());
+    // 开始会话不清空冷却与撤销记录：可以撤销到会话开始之前的抽取，重放同样能复现
+    TakeString(UndoDraw());
+    CHECK(Split(TakeString(UndoDraw())).size() == 2);
+    CHECK(TakeString(UndoDraw()) == "Nothing to undo!");
+    CHECK(Split(TakeString(RedoDraw())).size() == 2);
+    CHECK(AddExclusion(L"A", L"B") == 0);
+    TakeString(SimpleRandom(3));
+    ClearHistory();
+    TakeString(SimpleRandom(9));
+    TakeString(SimpleRandom(1));
+    uint64_t undoDepth = Metrics::Take()[Gauge::UndoDepth];
+    string transcript = TakeString(EndVerifiableSession());
+    CHECK(transcript.find("commitment " + commitment + "\n") != string::npos);
+    CHECK(transcript.size() > 5 && transcript.substr(transcript.size() - 4) == "end\n");
+    CHECK(TakeString(EndVerifiableSession()).empty());
+
+    // 用同一份名单离线重放：全部一致
+    RosterColumns columns;
+    columns.group = "Group";
+    RandomEngine replay;
+    CHECK(replay.Import(Platform::GetProfilePath("Session.csv"), columns) == 0);
+    size_t operations = 0;
+    string error;
+    CHECK(VerifyTranscript(replay, transcript, operations, error));
+    CHECK(operations == 11 && error.empty());
+    CHECK(replay.Cooldown() == 3 && replay.UndoDepth() == undoDepth);
+
+    // 篡改抽取结果、种子或换一份名单都无法通过验证
+    string tampered = transcript;
+    size_t line = tampered.find("draw 1 = ");
+    CHECK(line != string::npos);
+    tampered[line + 9] = tampered[line + 9] == '0' ? '1' : '0';
+    CHECK(!VerifyTranscript(replay, tampered, operations, error));
+    CHECK(error.find("differs") != string::npos);
+    tampered = transcript;
+    size_t seed = tampered.find("seed ") + 5;
+    tampered[seed] = tampered[seed] == '0' ? '1' : '0';
+    CHECK(!VerifyTranscript(replay, tampered, operations, error));
+    CHECK(error.find("commitment") != string::npos);
+    RandomEngine other;
+    CHECK(other.Import(Platform::GetProfilePath("Session.csv")) == 0);
+    CHECK(!VerifyTranscript(other, transcript, operations, error));
+
+    // 会话期间重新导入名单：记录中断，中断之前的部分仍可验证
+    CHECK(RandomImportGrouped(L"Session", L"Group") == 0);
+    TakeString(BeginVerifiableSession());
+    TakeString(SimpleRandom(2));
+    CHECK(RandomImportGrouped(L"Session", L"Group") == 0);
+    TakeString(SimpleRandom(2));
+    transcript = TakeString(EndVerifiableSession());
+    CHECK(transcript.find("interrupted\nend\n") != string::npos);
+    CHECK(VerifyTranscript(replay, transcript, operations, error) && operations == 1);
+
+    // 固定种子得到固定的记录：取整与洗牌的算法不依赖标准库，各平台录制的记录都能在其他平台重放
+    WriteProfile("Pinned", "ID,Name,Group\n1,A,g1\n2,B,g1\n3,C,g1\n4,D,g2\n5,E,g2\n6,F,g3\n7,G,g3\n8,H,g3\n");
+    RandomEngine pinned;
+    CHECK(pinned.Import(Platform::GetProfilePath("Pinned.csv"), columns) == 0);
+    array<uint8_t, 32> pinnedSeed;
+    iota(pinnedSeed.begin(), pinnedSeed.end(), uint8_t(0));
+    VerifiableSession fixedSession;
+    fixedSession.Begin(pinned, pinnedSeed);
+    vector<int> picked;
+    DrawStatus status = pinned.Draw(3, picked, fixedSession.Stream());
+    fixedSession.Record("draw", { 3 }, status, picked);
+    status = pinned.DrawStratified(StratifyMode::Proportional, 4, picked, fixedSession.Stream());
+    fixedSession.Record("stratified", { 1, 4 }, status, picked);
+    for (int number : { 1, 2 })
+    {
+        status = pinned.Draw(number, picked, fixedSession.Stream());
+        fixedSession.Record("draw", { number }, status, picked);
+    }
+    transcript = fixedSession.Reveal();
+    CHECK(transcript == PINNED_TRANSCRIPT);
+    CHECK(VerifyTranscript(pinned, PINNED_TRANSCRIPT, operations, error) && operations == 4);
+}
+
+static void TestUnionRoster()
+{
+    WriteProfile("ClassA", "ID,Name\n1,A\n2,B\n3,C\n4,D\n");
+    WriteProfile("Club", "ID,Name\n1,C\n2,D\n3,E\n4,F\n");
+    int a = RosterLoad(L"ClassA");
+    int club = RosterLoad(L"Club");
+    CHECK(a > 0 && club > 0 && a != club);
+    CHECK(RosterLoad(L"DoesNotExist") == -1);
+    int bad[] = { a, 9999 };
+    CHECK(RosterUnion(bad, 2) == -1);
+    int members[] = { a, club };
+    int view = RosterUnion(members, 2);
+    CHECK(view > 0 && RosterSize(view) == 6);
+
+    // 重复的同学只算一人：一轮恰好抽到 6 个不同的姓名；视图的历史与成员名单的历史互不影响
+    vector<string> round = Split(TakeString(RosterDraw(view, 4)));
+    vector<string> rest = Split(TakeString(RosterDraw(view, 2)));
+    set<string> all(round.begin(), round.end());
+    all.insert(rest.begin(), rest.end());
+    CHECK(all == (set<string>{ "A", "B", "C", "D", "E", "F" }));
+    CHECK(Split(TakeString(RosterDraw(a, 4))).size() == 4);
+    CHECK(Split(TakeString(RosterDraw(view, 6))).size() == 6); // 抽满后自动开始新一轮
+    TakeString(RosterDraw(view, 1));
+    CHECK(TakeString(RosterDraw(view, 6)) == "Not enough available students!");
+    RosterClearHistory(view);
+    CHECK(Split(TakeString(RosterDraw(view, 6))).size() == 6);
+
+    // 与名单运算一样按规范化姓名判断是否同一人
+    WriteProfile("Band", "ID,Name\n1,c\n2,\xE3\x80\x80" "D\n3,G\n");
+    int band = RosterLoad(L"Band");
+    int mixed[] = { a, band };
+    int view2 = RosterUnion(mixed, 2);
+    CHECK(view2 > 0 && RosterSize(view2) == 5);
+    vector<string> drawn = Split(TakeString(RosterDraw(view2, 5)));
+    CHECK(set<string>(drawn.begin(), drawn.end()) == (set<string>{ "A", "B", "C", "D", "G" }));
+    RosterRelease(view2);
+    RosterRelease(band);
+
+    // 释放成员句柄后视图仍可用
+    RosterRelease(a);
+    CHECK(RosterSize(a) == -1);
+    CHECK(TakeString(RosterDraw(a, 1)) == "Not Initialized!");
+    CHECK(Split(TakeString(RosterDraw(view, 1))).size() == 1);
+    RosterRelease(view);
+    RosterRelease(club);
+}
+
+static void TestRosterAlgebra()
+{
+    CHECK(NormalizeName("  Li\xE3\x80\x80 Hua ") == "li hua");
+    WriteProfile("AlgebraClass", "ID,Name,Group\n1,Tom,G1\n2,Li Hua,G1\n3,小明,G2\n4,Amy,G2\n");
+    WriteProfile("AlgebraClub", "ID,Name\n9,tom\n2,LI  HUA\n7,小红\n");
+    int cls = RosterLoad(L"AlgebraClass");
+    int club = RosterLoad(L"AlgebraClub");
+    auto names = [](int handle) {
+        vector<string> out = Split(TakeString(RosterDraw(handle, RosterSize(handle))));
+        return set<string>(out.begin(), out.end());
+    };
+
+    // 按规范化姓名匹配：Tom 与 tom、Li Hua 与 LI  HUA 是同一人，结果保留左侧名单的写法
+    int both = RosterCombine(cls, club, 0, 0);
+    CHECK(names(both) == (set<string>{ "Tom", "Li Hua" }));
+    CHECK(names(RosterCombine(cls, club, 1, 0)) == (set<string>{ "小明", "Amy" }));
+    CHECK(names(RosterCombine(cls, club, 2, 0)) == (set<string>{ "Tom", "Li Hua", "小明", "Amy", "小红" }));
+    // 按学号匹配：只有学号 2 相同
+    CHECK(names(RosterCombine(cls, club, 0, 1)) == (set<string>{ "Li Hua" }));
+    CHECK(RosterCombine(club, club, 1, 0) == -2);
+    CHECK(RosterCombine(cls, 9999, 0, 0) == -1);
+
+    // 结果设为全局名单后可使用全部抽取方式，分组信息随之保留
+    int rest = RosterCombine(cls, club, 1, 0);
+    CHECK(RosterActivate(rest) == 0);
+    CHECK(Split(TakeString(StratifiedRandom(0, 0))).size() == 1); // 小明与 Amy 同在 G2
+    CHECK(Split(TakeString(SimpleRandom(1))).size() == 1);
+    CHECK(TakeString(SimpleRandom(3)) == "Not enough students!");
+    for (int handle : { cls, club, both, rest })
+        RosterRelease(handle);
+}
+
+static void TestScores()
+{
+    WriteProfile("Scores", "ID,Name\n1,A\n2,B\n3,C\n4,D\n5,E\n");
+    CHECK(RandomImport(L"Scores") == 0);
+    CHECK(AwardScore(L"B", 3) == 0);
+    CHECK(AwardScore(L"D", 5) == 0);
+    CHECK(AwardScore(L"E", -2) == 0);
+    CHECK(AwardScore(L"B", 2) == 0);
+    CHECK(AwardScore(L"Nobody", 1) == -1);
+    // 同分时名单中靠前者在前
+    CHECK(TakeString(ScoreBoard(3)) == "B:5  D:5  A:0");
+    CHECK(TakeString(ScoreBoard(-2)) == "E:-2  A:0");
+    CHECK(Split(TakeString(ScoreBoard(100))).size() == 5);
+
+    // 积分随状态快照保存与恢复
+    vector<uint8_t> state(SaveState(nullptr, 0));
+    SaveState(state.data(), static_cast<int>(state.size()));
+    ClearScores();
+    CHECK(TakeString(ScoreBoard(1)) == "A:0");
+    CHECK(LoadState(state.data(), static_cast<int>(state.size())) == 0);
+    CHECK(TakeString(ScoreBoard(2)) == "B:5  D:5");
+
+    // 与逐次排序的结果对照，加分饱和到 int32 范围
+    RandomEngine scored;
+    vector<string> names(300);
+    for (size_t i = 0; i < names.size(); i++) names[i] = "S" + to_string(i);
+    scored.Load(names);
+    mt19937 gen(7);
+    vector<int> ranked;
+    for (int round = 0; round < 2000; round++)
+    {
+        int index = static_cast<int>(gen() % names.size());
+        scored.AddScore(index, static_cast<int32_t>(gen() % 21) - 10);
+        if (round % 100 != 0) continue;
+        vector<int> order(names.size());
+        iota(order.begin(), order.end(), 0);
+        stable_sort(order.begin(), order.end(), [&](int a, int b) { return scored.Score(a) > scored.Score(b); });
+        scored.Ranking(10, true, ranked);
+        CHECK(ranked == vector<int>(order.begin(), order.begin() + 10));
+        stable_sort(order.begin(), order.end(), [&](int a, int b) { return scored.Score(a) < scored.Score(b); });
+        scored.Ranking(10, false, ranked);
+        CHECK(ranked == vector<int>(order.begin(), order.begin() + 10));
+    }
+    scored.AddScore(0, INT32_MAX);
+    CHECK(scored.AddScore(0, INT32_MAX) == INT32_MAX);
+    scored.Ranking(1, true, ranked);
+    CHECK(ranked == vector<int>{ 0 });
+}
+
+static void TestTOTP()
+{
+    // RFC 4226 附录 D 测试向量
+    const string key = "12345678901234567890";
+    const uint8_t* k = reinterpret_cast<const uint8_t*>(key.data());
+    CHECK(HotpCode(k, key.size(), 0, 6) == "755224");
+    CHECK(HotpCode(k, key.size(), 9, 6) == "520489");
+    CHECK(Base32Encode(vector<uint8_t>(key.begin(), key.end())) == "GEZDGNBVGY3TQOJQGEZDGNBVGY3TQOJQ");
+
+    vector<uint8_t> decoded;
+    CHECK(Base32Decode("gezd gnbv gy3t qojq gezdgnbvgy3tqojq====", decoded));
+    CHECK(string(decoded.begin(), decoded.end()) == key);
+    CHECK(!Base32Decode("GEZ1", decoded));
+
+    string url = TakeString(CreateTOTPUrl());
+    CHECK(url.rfind("otpauth://totp/IslandCaller:Administrator?secret=", 0) == 0);
+
+    vector<uint8_t> secret;
+    CHECK(Platform::ReadSecret(TOTP_SECRET_NAME, secret) == 0);
+    CHECK(secret.size() == 20);
+    OtpauthUrl parsed;
+    CHECK(ParseOtpauthUrl(url, parsed));
+    CHECK(parsed.secret == secret);
+    CHECK(parsed.label == "IslandCaller:Administrator" && parsed.issuer == "IslandCaller");
+    CHECK(parsed.digits == 6 && parsed.period == 30);
+    uint64_t counter = chrono::duration_cast<chrono::seconds>(chrono::system_clock::now().time_since_epoch()).count() / 30;
+    string code = HotpCode(secret.data(), secret.size(), counter, 6);
+    CHECK(VerifyTOTP(wstring(code.begin(), code.end()).c_str()));
+    CHECK(!VerifyTOTP(L"abcdef"));
+}
+
+static void TestTracing()
+{
+    WriteProfile("Trace", "ID,Name,Gender\n1,A,0\n2,B,1\n");
+    ResetTraceStats();
+    SetTracingEnabled(true);
+    CHECK(RandomImport(L"Trace") == 0);
+    TakeString(SimpleRandom(1));
+    TakeString(SimpleRandom(1));
+    SetTracingEnabled(false);
+    TakeString(SimpleRandom(1));
+    string snapshot = TakeString(GetTraceSnapshot());
+    CHECK(snapshot.find("\"import\":{\"count\":1,") != string::npos);
+    CHECK(snapshot.find("\"parse\":{\"count\":1,") != string::npos);
+    CHECK(snapshot.find("\"draw\":{\"count\":2,") != string::npos);
+    CHECK(snapshot.find("\"verify\":{\"count\":0}") != string::npos);
+    CHECK(snapshot.find("\"p99_ns\":") != string::npos);
+}
+
+// 在 Debug 级别下生成并验证 TOTP，输出中不得出现密钥、URL 或验证码
+static void TestLogRedaction()
+{
+    mutex capturedMutex;
+    string captured;
+    Log::SetSink([&](string_view line) {
+        lock_guard<mutex> lock(capturedMutex);
+        captured += line;
+    });
+    Log::SetLevel(LogLevel::Debug);
+
+    string url = TakeString(CreateTOTPUrl());
+    OtpauthUrl parsed;
+    CHECK(ParseOtpauthUrl(url, parsed));
+    string secretB32 = Base32Encode(parsed.secret);
+    uint64_t counter = chrono::duration_cast<chrono::seconds>(chrono::system_clock::now().time_since_epoch()).count() / 30;
+    string code = HotpCode(parsed.secret.data(), parsed.secret.size(), counter, 6);
+    CHECK(VerifyTOTP(wstring(code.begin(), code.end()).c_str()));
+    CHECK(!VerifyTOTP(L"987654321"));
+    Log::Flush();
+
+    Log::SetLevel(LogLevel::Info);
+    Log::SetSink(nullptr);
+    lock_guard<mutex> lock(capturedMutex);
+    CHECK(captured.find("IslandCaller.Core | Success | TOTP secret and url created successfully\n") != string::npos);
+    CHECK(captured.find("TOTP URL issued, secret <redacted> (20 bytes)") != string::npos);
+    CHECK(captured.find("user provided code <redacted> (9 characters)") != string::npos);
+    CHECK(captured.find("IslandCaller.Core | Failed | TOTP code wrong\n") != string::npos);
+    CHECK(captured.find(secretB32) == string::npos);
+    CHECK(captured.find("otpauth://") == string::npos);
+    CHECK(captured.find(": " + code) == string::npos);
+    CHECK(captured.find("987654321") == string::npos);
+    CHECK(Log::Dropped() == 0);
+}
+
+static void TestMetrics()
+{
+    WriteProfile("Metrics", "ID,Name\n1,A\n2,B\n3,C\n");
+    Metrics::Snapshot before = Metrics::Take();
+    CHECK(RandomImport(L"Metrics") == 0);
+    CHECK(RandomImport(L"MetricsMissing") != 0);
+    CHECK(RandomImport(L"Metrics") == 0);
+    TakeString(SimpleRandom(2));
+    TakeString(SimpleRandom(5));
+    TakeString(SimpleRandom(1));
+    TakeString(SimpleRandom(1)); // 一轮结束，自动清空
+    CHECK(!VerifyTOTP(L"abcdef"));
+    Metrics::Snapshot after = Metrics::Take();
+
+    auto delta = [&](Counter c) { return after[c] - before[c]; };
+    CHECK(delta(Counter::ImportCalls) == 3);
+    CHECK(delta(Counter::ImportErrors) == 1);
+    CHECK(delta(Counter::BytesParsed) == 2 * 20);
+    CHECK(delta(Counter::RowsParsed) == 6);
+    CHECK(delta(Counter::DrawCalls) == 4);
+    CHECK(delta(Counter::DrawErrors) == 1);
+    CHECK(delta(Counter::StudentsDrawn) == 4);
+    CHECK(delta(Counter::HistoryClears) == 1);
+    CHECK(delta(Counter::TotpVerifyCalls) == 1 && delta(Counter::TotpVerifyRejected) == 1);
+    CHECK(after[Gauge::RosterSize] == 3 && after[Gauge::HistorySize] == 1);
+
+    // 各线程分片的计数在汇总时不丢失（包括已退出的线程）
+    vector<thread> threads;
+    for (int t = 0; t < 4; t++)
+        threads.emplace_back([] { for (int i = 0; i < 10000; i++) Metrics::Add(Counter::HelloVerifyCalls); });
+    for (auto& t : threads) t.join();
+    CHECK(Metrics::Take()[Counter::HelloVerifyCalls] - after[Counter::HelloVerifyCalls] == 40000);
+
+    string json = TakeString(GetMetricsSnapshot());
+    CHECK(json.find("\"roster_size\":3") != string::npos);
+    CHECK(json.find("\"history_fill\":0.333") != string::npos);
+}
+
+static void TestIpc()
+{
+#ifdef _WIN32
+    const string endpoint = "\\\\.\\pipe\\IslandCallerTests";
+#else
+    const string endpoint = testHome + "/test.sock";
+#endif
+    WriteProfile("Ipc", "ID,Name\n1,A\n2,B\n3,C\n");
+    CHECK(RandomImport(L"Ipc") == 0);
+    wstring endpointW(endpoint.begin(), endpoint.end());
+    CHECK(StartIpcServer(endpointW.c_str()) == 0);
+    CHECK(StartIpcServer(endpointW.c_str()) != 0); // 同一时间只有一个服务
+
+    Ipc::Client client;
+    Ipc::Status status;
+    string payload;
+    CHECK(client.Connect(endpoint));
+    CHECK(client.Call(Ipc::Op::Ping, 0, status, payload) && status == Ipc::Status::Ok && payload.empty());
+    CHECK(client.Call(Ipc::Op::Draw, 2, status, payload) && status == Ipc::Status::Ok);
+    vector<string> names = Split(payload);
+    CHECK(names.size() == 2 && names[0] != names[1]);
+    CHECK(client.Call(Ipc::Op::Draw, 2, status, payload) && status == Ipc::Status::DrawFailed);
+    CHECK(payload == DrawStatusMessage(DrawStatus::NotEnoughAvailable));
+    CHECK(client.Call(Ipc::Op::Clear, 0, status, payload) && status == Ipc::Status::Ok);
+    CHECK(client.Call(Ipc::Op::Draw, 3, status, payload) && status == Ipc::Status::Ok);
+    CHECK(client.Call(Ipc::Op::Stats, 0, status, payload) && payload.find("\"roster_size\":3") != string::npos);
+    CHECK(client.Call(Ipc::Op::Count, 0, status, payload) && status == Ipc::Status::BadRequest);
+
+    // 多个连接同时收发
+    vector<thread> threads;
+    atomic<int> ok{ 0 };
+    for (int t = 0; t < 4; t++)
+        threads.emplace_back([&] {
+            Ipc::Client c;
+            Ipc::Status s;
+            string p;
+            if (!c.Connect(endpoint)) return;
+            for (int i = 0; i < 100; i++)
+                if (c.Call(Ipc::Op::Ping, 0, s, p) && s == Ipc::Status::Ok) ok++;
+        });
+    for (auto& t : threads) t.join();
+    CHECK(ok == 400);
+
+#ifndef _WIN32
+    // 套接字文件只有本用户可以连接
+    struct stat info;
+    CHECK(stat(endpoint.c_str(), &info) == 0 && (info.st_mode & 0777) == 0600);
+    // 绑定时使用的私有目录已删除
+    for (const auto& entry : filesystem::directory_iterator(testHome))
+        CHECK(entry.path().filename().string().rfind("test.sock.", 0) != 0);
+
+    // 只发不收的客户端：应答积压到上限后服务端不再读取它的请求，发送方被套接字缓冲区挡住，其他连接照常服务
+    int flood = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    memcpy(address.sun_path, endpoint.data(), endpoint.size());
+    CHECK(connect(flood, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+    uint8_t request[Ipc::REQUEST_SIZE];
+    Ipc::EncodeRequest(Ipc::Op::Stats, 0, request);
+    string burst;
+    for (int i = 0; i < 1024; i++) burst.append(reinterpret_cast<const char*>(request), sizeof(request));
+    size_t sent = 0;
+    const int bursts = 2000;
+    for (int i = 0; i < bursts; i++)
+    {
+        ssize_t n = send(flood, burst.data(), burst.size(), MSG_DONTWAIT);
+        if (n > 0) sent += static_cast<size_t>(n);
+        else this_thread::sleep_for(chrono::microseconds(50));
+    }
+    CHECK(sent < bursts * burst.size() / 4);
+    CHECK(client.Call(Ipc::Op::Ping, 0, status, payload) && status == Ipc::Status::Ok);
+    close(flood);
+#endif
+
+    StopIpcServer();
+    CHECK(!client.Call(Ipc::Op::Ping, 0, status, payload));
+    CHECK(StartIpcServer(endpointW.c_str()) == 0); // 停止后可以重新启动
+    StopIpcServer();
+}
+
+int main()
+{
+    ios::sync_with_stdio(false); // 避免 stdout 被定为宽字符流后 cout 输出丢失
+    SetupHome();
+    TestImportParsing();
+    TestCsvQuoting();
+    TestImportFailures();
+    TestNoRepeatUntilCycle();
+    TestRecentlyDrawn();
+    TestStratified();
+    TestSeating();
+    TestUndo();
+    TestCooldown();
+    TestRandomStreams();
+    TestEntropyPool();
+    TestExclusions();
+    TestAnimation();
+    TestState();
+    TestVerifiableSession();
+    TestUnionRoster();
+    TestRosterAlgebra();
+    TestScores();
+    TestTOTP();
+    TestTracing();
+    TestLogRedaction();
+    TestMetrics();
+    TestIpc();
+    if (failures == 0)
+        cout << "All Core tests passed\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,340 @@
+// 抽取引擎统计质量测试：
+//   frequency    —— 每节课抽若干次后清空历史，检验每名学生被抽中次数是否均匀（卡方检验）
+//   pairs        —— 每次从空历史中抽 2~5 人，检验任意两人同时被抽中的次数是否均匀
+//   position     —— 每次从空历史中抽 3 人（小 k 内核）或 5 人（通用路径），检验每个输出位置上各学生出现次数是否均匀
+//   no-repeat    —— 连续抽取并随机清空历史，逐次核对一轮之内不重复、满一轮后自动重置
+//   union        —— 三份互相重叠的名单组成并集视图，检验并集中每名学生被抽中次数是否均匀（重复的同学不应更常被抽中）
+//   seeding      —— 不传入生成器的默认路径（与 SimpleRandom 相同，使用各线程从主流分出的随机数流）做一次较小规模的频率检验
+// 各线程持有独立的 RandomEngine 与生成器，计数最后合并
+// 带 --secure 时全部检验改用 ChaCha20 安全流（seeding 检验将全局名单设为安全模式）
+// 用法：ic_draw_quality [--draws 每项抽取次数] [--students 人数] [--threads 线程数] [--seed 种子] [--secure]
+
+#include "pch.h"
+#include "RandomEngine.h"
+#include "UnionRoster.h"
+#include <atomic>
+#include <functional>
+#include <thread>
+using namespace std;
+
+struct QualityOptions
+{
+    uint64_t draws = 1000000;
+    int students = 50;
+    int threads = 0;
+    uint32_t seed = 20240901;
+    bool secure = false;
+    double alpha = 1e-5; // 显著性水平，固定种子下结果可复现
+};
+
+static QualityOptions options;
+static int failures = 0;
+
+// ---------- 卡方分布 ----------
+
+// 正则化不完全伽马函数 Q(a, x) = Γ(a, x) / Γ(a)
+static double GammaQ(double a, double x)
+{
+    if (x <= 0) return 1.0;
+    double gln = lgamma(a);
+    if (x < a + 1)
+    {
+        // 级数展开求 P，再取 1 - P
+        double sum = 1.0 / a, term = sum;
+        for (int n = 1; n < 10000; n++)
+        {
+            term *= x / (a + n);
+            sum += term;
+            if (fabs(term) < fabs(sum) * 1e-15) break;
+        }
+        return 1.0 - sum * exp(-x + a * log(x) - gln);
+    }
+    // 连分式（Lentz 算法）
+    double b = x + 1 - a, c = 1e300, d = 1 / b, h = d;
+    for (int i = 1; i < 10000; i++)
+    {
+        double an = -i * (i - a);
+        b += 2;
+        d = an * d + b; if (fabs(d) < 1e-300) d = 1e-300;
+        c = b + an / c; if (fabs(c) < 1e-300) c = 1e-300;
+        d = 1 / d;
+        double delta = d * c;
+        h *= delta;
+        if (fabs(delta - 1) < 1e-15) break;
+    }
+    return exp(-x + a * log(x) - gln) * h;
+}
+
+// 观测计数与期望计数的卡方统计量及 p 值
+static double ChiSquareP(const vector<uint64_t>& observed, const vector<double>& expected, double* statOut = nullptr)
+{
+    double stat = 0;
+    for (size_t i = 0; i < observed.size(); i++)
+    {
+        double diff = observed[i] - expected[i];
+        stat += diff * diff / expected[i];
+    }
+    if (statOut) *statOut = stat;
+    return GammaQ((observed.size() - 1) / 2.0, stat / 2.0);
+}
+
+static void Report(const string& name, double p, double stat, size_t df)
+{
+    bool ok = p >= options.alpha;
+    cout << left << setw(26) << name << " chi2=" << setw(12) << fixed << setprecision(1) << stat
+        << " df=" << setw(6) << df << " p=" << scientific << setprecision(3) << p
+        << (ok ? "  ok\n" : "  FAIL\n") << defaultfloat;
+    if (!ok) ++failures;
+}
+
+// ---------- 并行执行 ----------
+
+static vector<string> MakeRoster(int n)
+{
+    vector<string> names;
+    for (int i = 0; i < n; i++) names.push_back("S" + to_string(i));
+    return names;
+}
+
+// 把 total 次抽取平均分给各线程，每个线程得到独立的引擎、生成器与计数数组，结束后按元素相加
+static vector<uint64_t> ParallelCount(size_t buckets, uint64_t total,
+    const function<void(RandomEngine&, RandomStream&, uint64_t, vector<uint64_t>&)>& work)
+{
+    int threads = options.threads;
+    vector<vector<uint64_t>> partial(threads, vector<uint64_t>(buckets));
+    vector<thread> pool;
+    for (int t = 0; t < threads; t++)
+    {
+        uint64_t share = total / threads + (t < static_cast<int>(total % threads) ? 1 : 0);
+        pool.emplace_back([&, t, share] {
+            RandomEngine engine;
+            engine.Load(MakeRoster(options.students));
+            engine.SetRandomMode(options.secure ? RandomMode::Secure : RandomMode::Fast);
+            // 同一种子下各线程的流由跳跃函数分出，互不重叠；安全模式下各线程使用不同的 nonce
+            Xoshiro256 fast(static_cast<uint64_t>(options.seed) << 32 | buckets);
+            for (int j = 0; j < t; j++) fast.Jump();
+            RandomStream gen = options.secure
+                ? RandomStream(ChaCha20({ options.seed, static_cast<uint32_t>(buckets) }, static_cast<uint64_t>(t)))
+                : RandomStream(fast);
+            work(engine, gen, share, partial[t]);
+        });
+    }
+    for (auto& th : pool) th.join();
+    vector<uint64_t> merged(buckets);
+    for (auto& p : partial)
+        for (size_t i = 0; i < buckets; i++) merged[i] += p[i];
+    return merged;
+}
+
+// ---------- 检验项 ----------
+
+// 每节课随机抽 1~8 次单人，然后清空历史
+static void TestFrequency()
+{
+    int n = options.students;
+    vector<uint64_t> counts = ParallelCount(n, options.draws, [](RandomEngine& engine, RandomStream& gen, uint64_t share, vector<uint64_t>& c) {
+        vector<int> picked;
+        uniform_int_distribution<int> lesson(1, 8);
+        uint64_t done = 0;
+        while (done < share)
+        {
+            engine.ClearHistory();
+            for (int i = lesson(gen); i > 0 && done < share; i--, done++)
+            {
+                engine.Draw(1, picked, gen);
+                c[picked[0]]++;
+            }
+        }
+    });
+    double stat;
+    double p = ChiSquareP(counts, vector<double>(n, static_cast<double>(options.draws) / n), &stat);
+    Report("frequency", p, stat, n - 1);
+}
+
+// 每次从空历史中抽 2~5 人，统计每一对同时出现的次数
+static void TestPairs()
+{
+    int n = options.students;
+    size_t pairs = static_cast<size_t>(n) * (n - 1) / 2;
+    auto pairIndex = [n](int a, int b) {
+        if (a > b) swap(a, b);
+        return static_cast<size_t>(a) * (2 * n - a - 1) / 2 + (b - a - 1);
+    };
+    // 末尾额外一个桶记录所有抽取的 C(k,2) 之和，用于计算期望
+    vector<uint64_t> counts = ParallelCount(pairs + 1, options.draws, [&](RandomEngine& engine, RandomStream& gen, uint64_t share, vector<uint64_t>& c) {
+        vector<int> picked;
+        uniform_int_distribution<int> size(2, 5);
+        for (uint64_t d = 0; d < share; d++)
+        {
+            engine.ClearHistory();
+            int k = size(gen);
+            engine.Draw(k, picked, gen);
+            for (int i = 0; i < k; i++)
+                for (int j = i + 1; j < k; j++)
+                    c[pairIndex(picked[i], picked[j])]++;
+            c[pairs] += static_cast<uint64_t>(k) * (k - 1) / 2;
+        }
+    });
+    double totalPairs = static_cast<double>(counts.back());
+    counts.pop_back();
+    double stat;
+    double p = ChiSquareP(counts, vector<double>(pairs, totalPairs / pairs), &stat);
+    Report("pairs", p, stat, pairs - 1);
+}
+
+// 每次从空历史中抽 k 人，统计 (位置, 学生) 的出现次数
+static void TestPosition(int k)
+{
+    int n = options.students;
+    vector<uint64_t> counts = ParallelCount(static_cast<size_t>(k) * n, options.draws, [&](RandomEngine& engine, RandomStream& gen, uint64_t share, vector<uint64_t>& c) {
+        vector<int> picked;
+        for (uint64_t d = 0; d < share; d++)
+        {
+            engine.ClearHistory();
+            engine.Draw(k, picked, gen);
+            for (int pos = 0; pos < k; pos++)
+                c[static_cast<size_t>(pos) * n + picked[pos]]++;
+        }
+    });
+    for (int pos = 0; pos < k; pos++)
+    {
+        vector<uint64_t> row(counts.begin() + static_cast<size_t>(pos) * n, counts.begin() + static_cast<size_t>(pos + 1) * n);
+        double stat;
+        double p = ChiSquareP(row, vector<double>(n, static_cast<double>(options.draws) / n), &stat);
+        Report("k" + to_string(k) + " position[" + to_string(pos) + "]", p, stat, n - 1);
+    }
+}
+
+// 并集视图：前三分之二、后三分之二与前四分之一三份名单的并集即全部学生，中间部分与开头部分各重复一次
+static void TestUnion()
+{
+    int n = options.students;
+    vector<uint64_t> counts = ParallelCount(n, options.draws, [n](RandomEngine&, RandomStream& gen, uint64_t share, vector<uint64_t>& c) {
+        vector<string> all = MakeRoster(n);
+        vector<shared_ptr<const RandomEngine>> members;
+        for (auto [first, last] : { make_pair(0, 2 * n / 3), make_pair(n / 3, n), make_pair(0, n / 4) })
+        {
+            auto member = make_shared<RandomEngine>();
+            member->Load(vector<string>(all.begin() + first, all.begin() + last));
+            members.push_back(member);
+        }
+        UnionRoster view(members);
+        vector<size_t> picked;
+        uniform_int_distribution<int> lesson(1, 8);
+        uint64_t done = 0;
+        while (done < share)
+        {
+            view.ClearHistory();
+            for (int i = lesson(gen); i > 0 && done < share; i--, done++)
+            {
+                view.Draw(1, picked, gen);
+                c[stoi(view.Name(picked[0]).substr(1))]++;
+            }
+        }
+    });
+    double stat;
+    double p = ChiSquareP(counts, vector<double>(n, static_cast<double>(options.draws) / n), &stat);
+    Report("union", p, stat, n - 1);
+}
+
+// 连续抽取 1~5 人并以 1/20 的概率清空历史，用一个独立的模型逐次核对引擎行为
+static void TestNoRepeat()
+{
+    int n = options.students;
+    vector<uint64_t> violations = ParallelCount(1, options.draws, [n](RandomEngine& engine, RandomStream& gen, uint64_t share, vector<uint64_t>& c) {
+        vector<int> picked;
+        vector<char> drawn(n, 0);
+        int drawnCount = 0;
+        uniform_int_distribution<int> size(1, 5);
+        uniform_int_distribution<int> clear(0, 19);
+        for (uint64_t d = 0; d < share; d++)
+        {
+            if (clear(gen) == 0)
+            {
+                engine.ClearHistory();
+                fill(drawn.begin(), drawn.end(), 0);
+                drawnCount = 0;
+            }
+            int k = size(gen);
+            // 引擎在本轮已全部抽完时于抽取前自动重置
+            if (drawnCount >= n)
+            {
+                fill(drawn.begin(), drawn.end(), 0);
+                drawnCount = 0;
+            }
+            DrawStatus status = engine.Draw(k, picked, gen);
+            DrawStatus expected = k > n - drawnCount ? DrawStatus::NotEnoughAvailable : DrawStatus::Ok;
+            if (status != expected) { c[0]++; continue; }
+            if (status != DrawStatus::Ok) continue;
+            if (static_cast<int>(picked.size()) != k) c[0]++;
+            for (int idx : picked)
+            {
+                if (idx < 0 || idx >= n || drawn[idx]) { c[0]++; continue; }
+                drawn[idx] = 1;
+                drawnCount++;
+            }
+            if (engine.HistorySize() != static_cast<size_t>(drawnCount)) c[0]++;
+        }
+    });
+    bool ok = violations[0] == 0;
+    cout << left << setw(26) << "no-repeat" << " violations=" << violations[0] << (ok ? "  ok\n" : "  FAIL\n");
+    if (!ok) ++failures;
+}
+
+// 默认路径使用各线程的随机数流（由系统熵池播种一次的主流分出），只做较小规模的频率检验
+static void TestSeeding()
+{
+    int n = options.students;
+    uint64_t draws = max<uint64_t>(static_cast<uint64_t>(n) * 200, options.draws / 50);
+    vector<uint64_t> counts = ParallelCount(n, draws, [](RandomEngine& engine, RandomStream&, uint64_t share, vector<uint64_t>& c) {
+        vector<int> picked;
+        for (uint64_t d = 0; d < share; d++)
+        {
+            engine.ClearHistory();
+            engine.Draw(1, picked);
+            c[picked[0]]++;
+        }
+    });
+    double stat;
+    double p = ChiSquareP(counts, vector<double>(n, static_cast<double>(draws) / n), &stat);
+    Report("seeding", p, stat, n - 1);
+}
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--draws" && i + 1 < argc) options.draws = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--students" && i + 1 < argc) options.students = atoi(argv[++i]);
+        else if (arg == "--threads" && i + 1 < argc) options.threads = atoi(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc) options.seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--secure") options.secure = true;
+        else
+        {
+            cerr << "usage: ic_draw_quality [--draws n] [--students n] [--threads n] [--seed n] [--secure]\n";
+            return 2;
+        }
+    }
+    if (options.students < 5)
+    {
+        cerr << "--students must be at least 5\n";
+        return 2;
+    }
+    if (options.threads <= 0)
+        options.threads = max(1u, thread::hardware_concurrency());
+
+    cout << "students=" << options.students << " draws=" << options.draws
+        << " threads=" << options.threads << " seed=" << options.seed << (options.secure ? " secure" : "") << "\n";
+    auto start = chrono::steady_clock::now();
+    TestFrequency();
+    TestPairs();
+    TestPosition(3);
+    TestPosition(5);
+    TestNoRepeat();
+    TestUnion();
+    TestSeeding();
+    cout << "elapsed " << fixed << setprecision(2)
+        << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,189 @@
+// Core 命令行驱动：不启动 ClassIsland 即可导入名单、批量抽取、查看计数、核对可验证抽取的记录或生成/验证 TOTP，
+// 输出均为 JSON，便于脚本处理，也可以直接挂在 perf 等性能分析工具下运行。
+// 用法：
+//   iccore import <名单.csv>
+//   iccore draw <名单.csv> [-k 每次人数] [--repeat 次数] [--cooldown 冷却人次] [--mode 0 快速|1 安全] [--quiet]
+//   iccore stats <名单.csv> [-k 每次人数] [--draws 次数]
+//   iccore verify <名单.csv> <记录.txt> [--group 分组列] [--row 行号列] [--column 列号列]
+//     （导入方式须与课上相同，否则快照与名单对不上）
+//   iccore totp create
+//   iccore totp verify <验证码>
+// 密钥存放位置与 Core 相同（可用 ISLANDCALLER_HOME 指定）；Core 的日志写到 stderr。
+
+#include "Exports.h"
+#include "RandomEngine.h"
+#include "Encoding.h"
+#include "Log.h"
+#include "VerifiableSession.h"
+#include <fstream>
+#include <map>
+#include <sstream>
+using namespace std;
+
+static int Usage()
+{
+    cerr << "usage: iccore import <roster.csv>\n"
+            "       iccore draw <roster.csv> [-k n] [--repeat n] [--cooldown n] [--mode n] [--quiet]\n"
+            "       iccore stats <roster.csv> [-k n] [--draws n]\n"
+            "       iccore verify <roster.csv> <transcript.txt> [--group col] [--row col] [--column col]\n"
+            "       iccore totp create\n"
+            "       iccore totp verify <code>\n";
+    return 2;
+}
+
+static string JsonString(const string& s)
+{
+    string out = "\"";
+    for (unsigned char c : s)
+    {
+        if (c == '"' || c == '\\') { out += '\\'; out += static_cast<char>(c); }
+        else if (c < 0x20)
+        {
+            char buffer[8];
+            snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            out += buffer;
+        }
+        else out += static_cast<char>(c);
+    }
+    return out + "\"";
+}
+
+// 把导出函数返回的 BSTR 转为 UTF-8 并释放
+static string TakeString(BSTR str)
+{
+    string out = WideToUtf8(str);
+    Platform::FreeString(str);
+    return out;
+}
+
+static bool Import(const string& path)
+{
+    if (RandomImportFromPath(Utf8ToWide(path).c_str()) == 0)
+        return true;
+    cout << "{\"ok\":false,\"error\":" << JsonString("cannot import " + path) << "}\n";
+    return false;
+}
+
+// 解析命令后面的可选参数，未知参数返回 false
+static bool ParseOptions(int argc, char** argv, int first, map<string, int>& numbers, map<string, string>& texts, bool& quiet)
+{
+    for (int i = first; i < argc; i++)
+    {
+        string a = argv[i];
+        if (a == "--quiet") quiet = true;
+        else if (numbers.count(a) && i + 1 < argc) numbers[a] = atoi(argv[++i]);
+        else if (texts.count(a) && i + 1 < argc) texts[a] = argv[++i];
+        else return false;
+    }
+    return true;
+}
+
+// 直接用 RandomEngine 抽取，按下标输出姓名：姓名中可能含有连续空格，不能拆分 DrawNames 的显示文本
+static int Draw(const string& path, int k, int repeat, int cooldown, int mode, bool quiet)
+{
+    RandomEngine roster;
+    if (roster.Import(path) != 0)
+    {
+        cout << "{\"ok\":false,\"error\":" << JsonString("cannot import " + path) << "}\n";
+        return 1;
+    }
+    roster.SetCooldown(static_cast<size_t>(max(cooldown, 0)));
+    if (mode == static_cast<int>(RandomMode::Secure)) roster.SetRandomMode(RandomMode::Secure);
+    vector<int> picked;
+    int failures = 0;
+    cout << "{\"ok\":true,\"k\":" << k << ",\"draws\":[";
+    for (int i = 0; i < repeat; i++)
+    {
+        DrawStatus status = roster.Draw(k, picked);
+        if (status != DrawStatus::Ok) failures++;
+        if (quiet) continue;
+        cout << (i ? "," : "");
+        if (status != DrawStatus::Ok)
+        {
+            cout << "{\"error\":" << JsonString(DrawStatusMessage(status)) << "}";
+            continue;
+        }
+        cout << "[";
+        for (size_t j = 0; j < picked.size(); j++)
+            cout << (j ? "," : "") << JsonString(roster.Name(picked[j]));
+        cout << "]";
+    }
+    cout << "],\"failures\":" << failures << "}\n";
+    return failures == 0 ? 0 : 1;
+}
+
+static int Stats(const string& path, int k, int draws)
+{
+    SetTracingEnabled(true);
+    if (!Import(path)) return 1;
+    string names;
+    for (int i = 0; i < draws; i++)
+        DrawNames(k, names);
+    cout << "{\"ok\":true,\"metrics\":" << TakeString(GetMetricsSnapshot())
+         << ",\"trace\":" << TakeString(GetTraceSnapshot()) << "}\n";
+    return 0;
+}
+
+// 用同一份名单重放可验证抽取的记录文本，核对承诺值与每一次抽取
+static int Verify(const string& rosterPath, const string& transcriptPath, const RosterColumns& columns)
+{
+    RandomEngine roster;
+    if (roster.Import(rosterPath, columns) != 0)
+    {
+        cout << "{\"ok\":false,\"error\":" << JsonString("cannot import " + rosterPath) << "}\n";
+        return 1;
+    }
+    ifstream file(transcriptPath, ios::binary);
+    if (!file)
+    {
+        cout << "{\"ok\":false,\"error\":" << JsonString("cannot read " + transcriptPath) << "}\n";
+        return 1;
+    }
+    stringstream transcript;
+    transcript << file.rdbuf();
+    size_t operations = 0;
+    string error;
+    bool verified = VerifyTranscript(roster, transcript.str(), operations, error);
+    cout << "{\"ok\":true,\"verified\":" << (verified ? "true" : "false") << ",\"operations\":" << operations;
+    if (!verified) cout << ",\"error\":" << JsonString(error);
+    cout << "}\n";
+    return verified ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+    ios::sync_with_stdio(false);
+    // 日志改写到 stderr，stdout 只输出 JSON
+    Log::SetSink([](string_view line) { fwrite(line.data(), 1, line.size(), stderr); });
+    if (argc < 2) return Usage();
+    string command = argv[1];
+    map<string, int> numbers = { { "-k", 1 }, { "--repeat", 1 }, { "--draws", 1000 }, { "--cooldown", 0 }, { "--mode", 0 } };
+    map<string, string> texts = { { "--group", "" }, { "--row", "" }, { "--column", "" } };
+    bool quiet = false;
+
+    if (command == "import" && argc == 3)
+    {
+        if (!Import(argv[2])) return 1;
+        cout << "{\"ok\":true,\"metrics\":" << TakeString(GetMetricsSnapshot()) << "}\n";
+        return 0;
+    }
+    if (command == "draw" && argc >= 3 && ParseOptions(argc, argv, 3, numbers, texts, quiet))
+        return Draw(argv[2], numbers["-k"], numbers["--repeat"], numbers["--cooldown"], numbers["--mode"], quiet);
+    if (command == "stats" && argc >= 3 && ParseOptions(argc, argv, 3, numbers, texts, quiet))
+        return Stats(argv[2], numbers["-k"], numbers["--draws"]);
+    if (command == "verify" && argc >= 4 && ParseOptions(argc, argv, 4, numbers, texts, quiet))
+        return Verify(argv[2], argv[3], { texts["--group"], texts["--row"], texts["--column"] });
+    if (command == "totp" && argc == 3 && string(argv[2]) == "create")
+    {
+        string url = TakeString(CreateTOTPUrl());
+        cout << "{\"ok\":" << (url.empty() ? "false" : "true") << ",\"url\":" << JsonString(url) << "}\n";
+        return url.empty() ? 1 : 0;
+    }
+    if (command == "totp" && argc == 4 && string(argv[2]) == "verify")
+    {
+        bool verified = VerifyTOTP(Utf8ToWide(argv[3]).c_str());
+        cout << "{\"ok\":true,\"verified\":" << (verified ? "true" : "false") << "}\n";
+        return verified ? 0 : 1;
+    }
+    return Usage();
+}
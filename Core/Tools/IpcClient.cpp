@@ -0,0 +1,116 @@
+// 本地 IPC 客户端：既可作为快捷方式直接抽取，也可在并发负载下测量往返延迟
+// 用法：ic_ipc_client [--endpoint 端点] [--op ping|draw|clear|stats] [--arg n]
+//                     [--clients 并发连接数] [--requests 每个连接的请求数] [--serve 名单名]
+// 只发一条请求时打印应答内容；否则以 JSON 输出往返延迟的分位数与总吞吐量。
+// --serve 时先在本进程内导入名单并启动服务，便于在没有 ClassIsland 的环境下测量。
+
+#include "Exports.h"
+#include "IpcServer.h"
+#include "Encoding.h"
+#include <thread>
+using namespace std;
+using Clock = chrono::steady_clock;
+
+int main(int argc, char** argv)
+{
+    ios::sync_with_stdio(false);
+    string endpoint = Platform::GetIpcEndpoint();
+    string opName = "ping";
+    string serveRoster;
+    int arg = 1;
+    int clients = 1;
+    int requests = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        string a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (a == "--endpoint" && hasValue) endpoint = argv[++i];
+        else if (a == "--op" && hasValue) opName = argv[++i];
+        else if (a == "--arg" && hasValue) arg = atoi(argv[++i]);
+        else if (a == "--clients" && hasValue) clients = max(1, atoi(argv[++i]));
+        else if (a == "--requests" && hasValue) requests = max(1, atoi(argv[++i]));
+        else if (a == "--serve" && hasValue) serveRoster = argv[++i];
+        else
+        {
+            cerr << "usage: ic_ipc_client [--endpoint path] [--op ping|draw|clear|stats] [--arg n] [--clients n] [--requests n] [--serve roster]\n";
+            return 2;
+        }
+    }
+
+    static const char* OP_NAMES[] = { "ping", "draw", "clear", "stats" };
+    auto found = find(begin(OP_NAMES), end(OP_NAMES), opName);
+    if (found == end(OP_NAMES))
+    {
+        cerr << "unknown op: " << opName << "\n";
+        return 2;
+    }
+    Ipc::Op op = static_cast<Ipc::Op>(found - begin(OP_NAMES));
+
+    if (!serveRoster.empty())
+    {
+        if (RandomImport(Utf8ToWide(serveRoster).c_str()) != 0)
+            return 1;
+        if (StartIpcServer(Utf8ToWide(endpoint).c_str()) != 0)
+        {
+            cerr << "cannot listen on " << endpoint << "\n";
+            return 1;
+        }
+    }
+
+    // 单条请求：作为快捷方式使用
+    if (clients == 1 && requests == 1)
+    {
+        Ipc::Client client;
+        Ipc::Status status;
+        string payload;
+        if (!client.Connect(endpoint) || !client.Call(op, static_cast<uint16_t>(arg), status, payload))
+        {
+            cerr << "cannot reach " << endpoint << "\n";
+            return 1;
+        }
+        cout << payload << "\n";
+        StopIpcServer();
+        return status == Ipc::Status::Ok ? 0 : 1;
+    }
+
+    // 负载测试：每个线程一条连接，串行发送请求并记录每次往返的耗时
+    vector<vector<double>> latencies(clients);
+    atomic<int> failures{ 0 };
+    vector<thread> threads;
+    auto start = Clock::now();
+    for (int t = 0; t < clients; t++)
+    {
+        threads.emplace_back([&, t] {
+            Ipc::Client client;
+            if (!client.Connect(endpoint)) { failures++; return; }
+            Ipc::Status status;
+            string payload;
+            latencies[t].reserve(requests);
+            for (int r = 0; r < requests; r++)
+            {
+                auto t0 = Clock::now();
+                if (!client.Call(op, static_cast<uint16_t>(arg), status, payload)) { failures++; return; }
+                latencies[t].push_back(chrono::duration<double, micro>(Clock::now() - t0).count());
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    double seconds = chrono::duration<double>(Clock::now() - start).count();
+    StopIpcServer();
+
+    vector<double> all;
+    for (auto& l : latencies) all.insert(all.end(), l.begin(), l.end());
+    sort(all.begin(), all.end());
+    auto quantile = [&](double q) {
+        return all.empty() ? 0.0 : all[min(all.size() - 1, static_cast<size_t>(q * all.size()))];
+    };
+    string escaped;
+    for (char c : endpoint) escaped += c == '\\' ? string("\\\\") : string(1, c);
+    cout << fixed << setprecision(2)
+        << "{\"endpoint\":\"" << escaped << "\",\"op\":\"" << opName << "\",\"clients\":" << clients
+        << ",\"requests\":" << all.size() << ",\"failures\":" << failures.load()
+        << ",\"rtt_us\":{\"p50\":" << quantile(0.5) << ",\"p90\":" << quantile(0.9) << ",\"p99\":" << quantile(0.99)
+        << ",\"max\":" << (all.empty() ? 0.0 : all.back()) << "}"
+        << ",\"ops_per_s\":" << (seconds > 0 ? all.size() / seconds : 0.0) << "}\n";
+    return failures.load() == 0 ? 0 : 1;
+}
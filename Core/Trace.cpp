@@ -0,0 +1,229 @@
+#include "pch.h"
+#include "Trace.h"
+#include <bit>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+using namespace std;
+
+/*
+ * 直方图布局（对数-线性，与 HdrHistogram 相同的思路）：
+ * 小于 32 的值各占一个桶；更大的值按最高位分段，每段再按接下来的 5 位细分为 32 个桶，
+ * 因此任意值的相对误差不超过 1/32。记录上限为 2^40 个 tick（3GHz 下约 6 分钟），超出的记入最后一个桶。
+ *
+ * 每个线程拥有自己的一组直方图，只有所属线程写入（relaxed 读-改-写，不需要 lock 前缀），
+ * 导出时其他线程只做 relaxed 读取。线程退出后其直方图归还到空闲列表，由之后的新线程接着使用，
+ * 数据不会丢失，内存也不会随线程数无限增长。
+ */
+
+static constexpr int SUB_BITS = 5;
+static constexpr int SUB_COUNT = 1 << SUB_BITS;
+static constexpr int MAX_BITS = 40;
+static constexpr int BUCKETS = (MAX_BITS - SUB_BITS + 1) * SUB_COUNT;
+
+static const char* OP_NAMES[] = { "import", "parse", "draw", "verify" };
+static_assert(sizeof(OP_NAMES) / sizeof(OP_NAMES[0]) == static_cast<size_t>(TraceOp::Count));
+
+struct OpHistogram
+{
+    atomic<uint64_t> buckets[BUCKETS];
+    atomic<uint64_t> count;
+    atomic<uint64_t> sum;
+    atomic<uint64_t> min;
+    atomic<uint64_t> max;
+
+    void Clear()
+    {
+        for (auto& b : buckets) b.store(0, memory_order_relaxed);
+        count.store(0, memory_order_relaxed);
+        sum.store(0, memory_order_relaxed);
+        min.store(UINT64_MAX, memory_order_relaxed);
+        max.store(0, memory_order_relaxed);
+    }
+};
+
+struct ThreadHistograms
+{
+    OpHistogram ops[static_cast<size_t>(TraceOp::Count)];
+    ThreadHistograms() { for (auto& op : ops) op.Clear(); }
+};
+
+static mutex registryMutex;
+static vector<unique_ptr<ThreadHistograms>> registry; // 所有曾经分配过的直方图
+static vector<ThreadHistograms*> freeList;            // 已退出线程归还的直方图
+
+struct ThreadSlot
+{
+    ThreadHistograms* histograms = nullptr;
+
+    ThreadHistograms* Get()
+    {
+        if (!histograms)
+        {
+            lock_guard<mutex> lock(registryMutex);
+            if (!freeList.empty())
+            {
+                histograms = freeList.back();
+                freeList.pop_back();
+            }
+            else
+            {
+                registry.push_back(make_unique<ThreadHistograms>());
+                histograms = registry.back().get();
+            }
+        }
+        return histograms;
+    }
+
+    ~ThreadSlot()
+    {
+        if (histograms)
+        {
+            lock_guard<mutex> lock(registryMutex);
+            freeList.push_back(histograms);
+        }
+    }
+};
+
+static thread_local ThreadSlot slot;
+
+static bool EnabledFromEnvironment()
+{
+    const char* value = getenv("ISLANDCALLER_TRACE");
+    return value && value[0] == '1';
+}
+
+atomic<bool> Trace::enabled{ EnabledFromEnvironment() };
+
+static inline int BucketIndex(uint64_t ticks)
+{
+    if (ticks < SUB_COUNT) return static_cast<int>(ticks);
+    int msb = bit_width(ticks) - 1;
+    if (msb >= MAX_BITS) return BUCKETS - 1;
+    int shift = msb - SUB_BITS;
+    return (shift + 1) * SUB_COUNT + static_cast<int>((ticks >> shift) & (SUB_COUNT - 1));
+}
+
+// 桶的代表值（区间中点）
+static uint64_t BucketValue(int index)
+{
+    if (index < SUB_COUNT) return static_cast<uint64_t>(index);
+    int shift = index / SUB_COUNT - 1;
+    uint64_t low = static_cast<uint64_t>(SUB_COUNT + index % SUB_COUNT) << shift;
+    return low + ((uint64_t(1) << shift) >> 1);
+}
+
+static inline void Bump(atomic<uint64_t>& a, uint64_t delta)
+{
+    a.store(a.load(memory_order_relaxed) + delta, memory_order_relaxed);
+}
+
+void Trace::Record(TraceOp op, uint64_t ticks)
+{
+    OpHistogram& h = slot.Get()->ops[static_cast<size_t>(op)];
+    Bump(h.buckets[BucketIndex(ticks)], 1);
+    Bump(h.count, 1);
+    Bump(h.sum, ticks);
+    if (ticks < h.min.load(memory_order_relaxed)) h.min.store(ticks, memory_order_relaxed);
+    if (ticks > h.max.load(memory_order_relaxed)) h.max.store(ticks, memory_order_relaxed);
+}
+
+// 每纳秒的 tick 数：TSC 需要对照 steady_clock 校准一次，steady_clock 本身即为纳秒
+static double TicksPerNanosecond()
+{
+#if IC_TRACE_TSC
+    static double ratio = [] {
+        auto t0 = chrono::steady_clock::now();
+        uint64_t c0 = Trace::Now();
+        while (chrono::steady_clock::now() - t0 < chrono::milliseconds(10)) {}
+        uint64_t c1 = Trace::Now();
+        double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - t0).count();
+        return ns > 0 ? (c1 - c0) / ns : 1.0;
+    }();
+    return ratio;
+#else
+    using period = chrono::steady_clock::period;
+    return static_cast<double>(period::den) / (period::num * 1e9);
+#endif
+}
+
+void Trace::SetEnabled(bool on)
+{
+    if (on) TicksPerNanosecond(); // 提前校准，避免首次导出时阻塞
+    enabled.store(on, memory_order_relaxed);
+}
+
+void Trace::Reset()
+{
+    lock_guard<mutex> lock(registryMutex);
+    for (auto& histograms : registry)
+        for (auto& op : histograms->ops)
+            op.Clear();
+}
+
+string Trace::SnapshotJson()
+{
+    double ticksPerNs = TicksPerNanosecond();
+    ostringstream oss;
+    oss << fixed << setprecision(1);
+    oss << "{\"enabled\":" << (enabled.load(memory_order_relaxed) ? "true" : "false")
+        << ",\"clock\":\"" << (IC_TRACE_TSC ? "tsc" : "steady_clock") << "\""
+        << ",\"ticks_per_ns\":" << setprecision(4) << ticksPerNs << setprecision(1)
+        << ",\"ops\":{";
+
+    lock_guard<mutex> lock(registryMutex);
+    for (size_t op = 0; op < static_cast<size_t>(TraceOp::Count); op++)
+    {
+        vector<uint64_t> buckets(BUCKETS);
+        uint64_t count = 0, sum = 0, minTicks = UINT64_MAX, maxTicks = 0;
+        for (auto& histograms : registry)
+        {
+            const OpHistogram& h = histograms->ops[op];
+            for (int b = 0; b < BUCKETS; b++) buckets[b] += h.buckets[b].load(memory_order_relaxed);
+            count += h.count.load(memory_order_relaxed);
+            sum += h.sum.load(memory_order_relaxed);
+            minTicks = std::min(minTicks, h.min.load(memory_order_relaxed));
+            maxTicks = std::max(maxTicks, h.max.load(memory_order_relaxed));
+        }
+
+        oss << (op ? "," : "") << "\"" << OP_NAMES[op] << "\":{\"count\":" << count;
+        if (count > 0)
+        {
+            auto ns = [&](uint64_t ticks) { return ticks / ticksPerNs; };
+            oss << ",\"min_ns\":" << ns(minTicks) << ",\"max_ns\":" << ns(maxTicks)
+                << ",\"mean_ns\":" << ns(sum) / count;
+            const pair<const char*, double> quantiles[] = { { "p50", 0.5 }, { "p90", 0.9 }, { "p99", 0.99 }, { "p999", 0.999 } };
+            for (const auto& q : quantiles)
+            {
+                uint64_t target = static_cast<uint64_t>(ceil(q.second * count));
+                uint64_t seen = 0;
+                int b = 0;
+                for (; b < BUCKETS - 1; b++)
+                {
+                    seen += buckets[b];
+                    if (seen >= target) break;
+                }
+                uint64_t value = std::clamp(BucketValue(b), minTicks, maxTicks);
+                oss << ",\"" << q.first << "_ns\":" << ns(value);
+            }
+        }
+        oss << "}";
+    }
+    oss << "}}";
+    return oss.str();
+}
+
+EXPORT_DLL void SetTracingEnabled(bool enabled)
+{
+    Trace::SetEnabled(enabled);
+}
+
+EXPORT_DLL void ResetTraceStats()
+{
+    Trace::Reset();
+}
+
+EXPORT_DLL BSTR GetTraceSnapshot()
+{
+    return Platform::AllocString(Trace::SnapshotJson());
+}
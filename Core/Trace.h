@@ -0,0 +1,88 @@
+// 轻量级耗时追踪：在导入、解析、抽取、验证等操作外包一个作用域 span，
+// 用 TSC（非 x86 平台为 steady_clock）计时，结果写入线程本地的对数-线性直方图（HDR 风格，相对误差约 3%），
+// GetTraceSnapshot 导出时汇总所有线程的直方图。
+//
+// 运行时关闭时，span 入口只有一次 relaxed 读取加一个可预测的分支；
+// 编译时定义 IC_TRACING=0 则 IC_TRACE_SPAN 完全展开为空。
+// 启动时若设置了环境变量 ISLANDCALLER_TRACE=1 则默认开启。
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#ifndef IC_TRACING
+#define IC_TRACING 1
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define IC_TRACE_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define IC_TRACE_TSC 1
+#else
+#include <chrono>
+#define IC_TRACE_TSC 0
+#endif
+
+enum class TraceOp : uint8_t
+{
+    Import,     // RandomImport：打开文件到名单就绪
+    Parse,      // 解析 CSV
+    Draw,       // SimpleRandom：一次抽取（含输出字符串）
+    Verify,     // VerifyTOTP
+    Count
+};
+
+namespace Trace
+{
+    extern std::atomic<bool> enabled;
+
+    inline uint64_t Now()
+    {
+#if IC_TRACE_TSC
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    // 把一次耗时（Now() 的差值）记入当前线程的直方图
+    void Record(TraceOp op, uint64_t ticks);
+
+    void SetEnabled(bool on);
+    // 清零所有线程的直方图
+    void Reset();
+    // 汇总所有线程的直方图，按操作输出次数、最小/最大/平均值与分位数（纳秒）
+    std::string SnapshotJson();
+}
+
+class TraceSpan
+{
+public:
+    explicit TraceSpan(TraceOp op) : op(op)
+    {
+        if (Trace::enabled.load(std::memory_order_relaxed))
+            start = Trace::Now();
+    }
+    ~TraceSpan()
+    {
+        if (start)
+            Trace::Record(op, Trace::Now() - start);
+    }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    TraceOp op;
+    uint64_t start = 0;
+};
+
+#if IC_TRACING
+#define IC_TRACE_CONCAT_(a, b) a##b
+#define IC_TRACE_CONCAT(a, b) IC_TRACE_CONCAT_(a, b)
+#define IC_TRACE_SPAN(op) TraceSpan IC_TRACE_CONCAT(icTraceSpan, __LINE__)(op)
+#else
+#define IC_TRACE_SPAN(op) ((void)0)
+#endif
@@ -0,0 +1,129 @@
+#include "pch.h"
+#include "UnionRoster.h"
+#include "RosterAlgebra.h"
+#include <unordered_set>
+using namespace std;
+
+UnionRoster::UnionRoster(vector<shared_ptr<const RandomEngine>> members) : members(move(members))
+{
+    offsets.push_back(0);
+    for (const auto& member : this->members)
+        offsets.push_back(offsets.back() + member->Size());
+}
+
+size_t UnionRoster::MemberOf(size_t position) const
+{
+    return upper_bound(offsets.begin(), offsets.end(), position) - offsets.begin() - 1;
+}
+
+const string& UnionRoster::Name(size_t position) const
+{
+    size_t member = MemberOf(position);
+    return members[member]->Name(static_cast<int>(position - offsets[member]));
+}
+
+// 第一次抽取时按规范化姓名标出规范位置、统计并集人数并分配历史数组
+void UnionRoster::Prepare()
+{
+    if (prepared)
+        return;
+    prepared = true;
+    lastDrawnEpoch.resize(members.size());
+    canonical.resize(members.size());
+    // 更靠前的成员名单中出现过的姓名：直接指向成员名单里的姓名，按规范化后的字节哈希、比较，不复制
+    struct Hash { size_t operator()(string_view name) const { return static_cast<size_t>(NormalizedHash(name)); } };
+    struct Equal { bool operator()(string_view a, string_view b) const { return NormalizedEqual(a, b); } };
+    unordered_set<string_view, Hash, Equal> earlier;
+    earlier.reserve(offsets.back());
+    for (size_t m = 0; m < members.size(); m++)
+    {
+        const RandomEngine& member = *members[m];
+        size_t size = member.Size();
+        lastDrawnEpoch[m].assign(size, 0);
+        canonical[m].assign(size, 0);
+        for (size_t i = 0; i < size; i++)
+        {
+            if (earlier.count(member.Name(static_cast<int>(i))) == 0)
+            {
+                canonical[m][i] = 1;
+                unionSize++;
+            }
+        }
+        for (size_t i = 0; i < size; i++)
+            earlier.insert(member.Name(static_cast<int>(i)));
+    }
+}
+
+size_t UnionRoster::Size()
+{
+    Prepare();
+    return unionSize;
+}
+
+void UnionRoster::ClearHistory()
+{
+    drawnCount = 0;
+    if (++epoch == 0)
+    {
+        for (auto& history : lastDrawnEpoch)
+            fill(history.begin(), history.end(), 0);
+        epoch = 1;
+    }
+}
+
+DrawStatus UnionRoster::Draw(int number, vector<size_t>& picked, RandomStream& gen)
+{
+    picked.clear();
+    Prepare();
+    if (unionSize == 0)
+    {
+        return DrawStatus::NotInitialized;
+    }
+    if (number < 0 || static_cast<size_t>(number) > unionSize)
+    {
+        return DrawStatus::NotEnoughStudents;
+    }
+    if (drawnCount >= unionSize)
+    {
+        ClearHistory();
+    }
+    if (static_cast<size_t>(number) > unionSize - drawnCount)
+    {
+        return DrawStatus::NotEnoughAvailable;
+    }
+
+    // 在全部位置上均匀取样，落在非规范位置（重复的同学）或本轮已抽中的学生上就重抽，
+    // 接受的学生因此在剩余的并集中均匀分布；被接受者立即标记，同一次抽取内不会重复
+    auto available = [&](size_t position) {
+        size_t member = MemberOf(position);
+        int index = static_cast<int>(position - offsets[member]);
+        return lastDrawnEpoch[member][index] != epoch && IsCanonical(member, index);
+    };
+    auto accept = [&](size_t position) {
+        size_t member = MemberOf(position);
+        lastDrawnEpoch[member][position - offsets[member]] = epoch;
+        drawnCount++;
+        picked.push_back(position);
+    };
+    for (int attempts = 8 * number + 32; static_cast<int>(picked.size()) < number && attempts > 0; attempts--)
+    {
+        size_t candidate = static_cast<size_t>(gen.Below(offsets.back()));
+        if (available(candidate)) accept(candidate);
+    }
+
+    // 剩余的人太少时改为列出全部可选位置做部分 Fisher-Yates
+    if (static_cast<int>(picked.size()) < number)
+    {
+        vector<size_t> candidates;
+        for (size_t position = 0; position < offsets.back(); position++)
+        {
+            if (available(position)) candidates.push_back(position);
+        }
+        for (size_t i = 0; static_cast<int>(picked.size()) < number; i++)
+        {
+            swap(candidates[i], candidates[gen.Between(i, candidates.size() - 1)]);
+            accept(candidates[i]);
+        }
+    }
+    return DrawStatus::Ok;
+}
@@ -0,0 +1,38 @@
+// 并集名单视图：把若干已导入的名单看作一份名单抽取，不复制姓名
+// 姓名经 NormalizeName 规范化后相同的学生视为同一人（与 RosterAlgebra 的名单运算一致），只经由包含他的第一份名单被抽中（接受-拒绝），因此在并集上均匀；
+// 视图有自己的已抽取历史，与各成员名单自身的历史无关
+// 创建视图只记录成员与各自的人数前缀和，O(名单数)；并集人数与历史数组在第一次抽取时才计算、分配
+
+#pragma once
+#include "RandomEngine.h"
+#include <memory>
+
+class UnionRoster
+{
+public:
+    explicit UnionRoster(std::vector<std::shared_ptr<const RandomEngine>> members);
+
+    // 从并集中抽取 number 人，被抽中者的位置（各成员名单依次排列后的下标）写入 picked
+    // 与 RandomEngine::Draw 相同：并集全部抽过后自动清空，人数不足时返回相应状态
+    DrawStatus Draw(int number, std::vector<size_t>& picked, RandomStream& gen);
+    void ClearHistory();
+
+    const std::string& Name(size_t position) const;
+    size_t Size();                                  // 并集人数（去重后）
+    size_t HistorySize() const { return drawnCount; }
+
+private:
+    // 该学生是否没有出现在更靠前的成员名单中，Prepare 之后才可调用
+    bool IsCanonical(size_t member, int index) const { return canonical[member][index] != 0; }
+    size_t MemberOf(size_t position) const;
+    void Prepare();
+
+    std::vector<std::shared_ptr<const RandomEngine>> members;
+    std::vector<size_t> offsets;                    // 各成员在整体位置中的起点，末尾多一项为总人数
+    std::vector<std::vector<uint32_t>> lastDrawnEpoch; // 共享的已抽取历史，只在规范位置上标记
+    std::vector<std::vector<uint8_t>> canonical;    // 各位置是否为规范位置，Prepare 时按规范化姓名计算
+    uint32_t epoch = 1;
+    size_t drawnCount = 0;
+    size_t unionSize = 0;
+    bool prepared = false;
+};
@@ -0,0 +1,247 @@
+#include "pch.h"
+#include "VerifiableSession.h"
+#include "Sha256.h"
+#include <charconv>
+using namespace std;
+
+static const string_view TRANSCRIPT_MAGIC = "islandcaller-transcript 3";
+static constexpr size_t HEADER_FIRST = 3, HEADER_LINES = 2;
+
+static string Commit(const array<uint8_t, 32>& seed, string_view header)
+{
+    Sha256 sha;
+    sha.Update(seed.data(), seed.size());
+    sha.Update(header);
+    Sha256::Digest digest = sha.Final();
+    return HexEncode(digest.data(), digest.size());
+}
+
+// 种子按小端序作为 ChaCha20 密钥，nonce 为 0
+static RandomStream SessionStream(const array<uint8_t, 32>& seed)
+{
+    array<uint32_t, 8> key;
+    for (int i = 0; i < 8; i++)
+        key[i] = uint32_t(seed[4 * i]) | uint32_t(seed[4 * i + 1]) << 8 | uint32_t(seed[4 * i + 2]) << 16 | uint32_t(seed[4 * i + 3]) << 24;
+    return RandomStream(ChaCha20(key, 0));
+}
+
+string VerifiableSession::Begin(RandomEngine& engine, const array<uint8_t, 32>& seed)
+{
+    string state;
+    engine.SaveState(state);
+    vector<pair<int, int>> pairs;
+    engine.Exclusions(pairs);
+    header = "state " + HexEncode(reinterpret_cast<const uint8_t*>(state.data()), state.size())
+        + "\nexclusions";
+    for (const auto& [a, b] : pairs)
+    {
+        header += ' ';
+        header += to_string(a) + "," + to_string(b);
+    }
+    header += "\n";
+
+    this->seed = seed;
+    commitment = Commit(seed, header);
+    operations.clear();
+    stream = SessionStream(seed);
+    active = begun = true;
+    return commitment;
+}
+
+void VerifiableSession::Record(const char* op, initializer_list<int> args, DrawStatus status, const vector<int>& picked)
+{
+    if (!active) return;
+    operations += op;
+    for (int arg : args)
+    {
+        operations += ' ';
+        operations += to_string(arg);
+    }
+    if (status == DrawStatus::Ok)
+    {
+        operations += " =";
+        for (int index : picked)
+        {
+            operations += ' ';
+            operations += to_string(index);
+        }
+    }
+    else
+    {
+        operations += " ! ";
+        operations += to_string(static_cast<int>(status));
+    }
+    operations += "\n";
+}
+
+void VerifiableSession::Record(const char* op, initializer_list<int> args)
+{
+    if (!active) return;
+    operations += op;
+    for (int arg : args)
+    {
+        operations += ' ';
+        operations += to_string(arg);
+    }
+    operations += "\n";
+}
+
+void VerifiableSession::Interrupt()
+{
+    if (!active) return;
+    operations += "interrupted\n";
+    active = false;
+}
+
+string VerifiableSession::Reveal()
+{
+    if (!begun)
+        return string();
+    string text = string(TRANSCRIPT_MAGIC) + "\ncommitment " + commitment + "\nseed " + HexEncode(seed.data(), seed.size()) + "\n"
+        + header + operations + "end\n";
+    seed.fill(0);
+    stream.reset();
+    active = begun = false;
+    return text;
+}
+
+// ---------- 离线验证 ----------
+
+// 以空格分隔的整数，全部解析成功才返回 true
+static bool ParseInts(string_view text, vector<int>& out)
+{
+    out.clear();
+    size_t pos = 0;
+    while (pos < text.size())
+    {
+        if (text[pos] == ' ') { pos++; continue; }
+        int value;
+        auto result = from_chars(text.data() + pos, text.data() + text.size(), value);
+        if (result.ec != errc() || (result.ptr != text.data() + text.size() && *result.ptr != ' '))
+            return false;
+        out.push_back(value);
+        pos = result.ptr - text.data();
+    }
+    return true;
+}
+
+// 按 op 与 args 重放一次抽取，op 不是抽取时返回 false
+static bool ReplayDraw(RandomEngine& engine, string_view op, const vector<int>& args, RandomStream& gen,
+    vector<int>& picked, DrawStatus& status)
+{
+    if (op == "draw" && args.size() == 1)
+        status = engine.Draw(args[0], picked, gen);
+    else if (op == "stratified" && args.size() == 2)
+        status = engine.DrawStratified(args[0] == 0 ? StratifyMode::OnePerGroup : StratifyMode::Proportional, args[1], picked, gen);
+    else if (op == "spatial" && args.size() == 2)
+        status = engine.DrawSpatial(args[0] == 0 ? SpatialMode::NonAdjacent : SpatialMode::Cluster, args[1], picked, gen);
+    else
+        return false;
+    return true;
+}
+
+bool VerifyTranscript(RandomEngine& engine, string_view transcript, size_t& operations, string& error)
+{
+    operations = 0;
+    vector<string_view> lines;
+    for (size_t start = 0; start < transcript.size();)
+    {
+        size_t end = transcript.find('\n', start);
+        if (end == string_view::npos) end = transcript.size();
+        string_view line = transcript.substr(start, end - start);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        lines.push_back(line);
+        start = end + 1;
+    }
+    auto fail = [&](size_t line, const string& message) {
+        error = "line " + to_string(line + 1) + ": " + message;
+        return false;
+    };
+    auto value = [&](size_t line, string_view key, string_view& out) {
+        if (line >= lines.size() || lines[line].substr(0, key.size()) != key)
+            return false;
+        out = lines[line].substr(key.size());
+        if (!out.empty() && out[0] == ' ') out.remove_prefix(1);
+        return true;
+    };
+
+    string_view commitment, seedHex, stateHex, exclusionText;
+    if (lines.empty() || lines[0] != TRANSCRIPT_MAGIC)
+        return fail(0, "not a draw transcript");
+    if (!value(1, "commitment ", commitment)) return fail(1, "missing commitment");
+    if (!value(2, "seed ", seedHex)) return fail(2, "missing seed");
+    if (!value(3, "state ", stateHex)) return fail(3, "missing state");
+    if (!value(4, "exclusions", exclusionText)) return fail(4, "missing exclusions");
+
+    vector<uint8_t> bytes;
+    if (!HexDecode(seedHex, bytes) || bytes.size() != 32)
+        return fail(2, "seed must be 32 bytes");
+    array<uint8_t, 32> seed;
+    copy(bytes.begin(), bytes.end(), seed.begin());
+    string header;
+    for (size_t i = HEADER_FIRST; i < HEADER_FIRST + HEADER_LINES; i++)
+        header += string(lines[i]) + "\n";
+    if (Commit(seed, header) != commitment)
+        return fail(1, "commitment does not match seed and header");
+
+    if (!HexDecode(stateHex, bytes))
+        return fail(3, "state is not hex");
+    if (engine.LoadState(string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size())) != RandomEngine::StateError::Ok)
+        return fail(3, "state does not belong to this roster");
+    vector<int> numbers;
+    engine.ClearExclusions();
+    string pairs(exclusionText);
+    replace(pairs.begin(), pairs.end(), ',', ' ');
+    if (!ParseInts(pairs, numbers) || numbers.size() % 2 != 0)
+        return fail(4, "invalid exclusions");
+    for (size_t i = 0; i < numbers.size(); i += 2)
+        if (!engine.AddExclusion(numbers[i], numbers[i + 1]))
+            return fail(4, "invalid exclusion pair");
+
+    RandomStream gen = SessionStream(seed);
+    vector<int> args, expected, picked, scratch;
+    bool interrupted = false;
+    for (size_t i = HEADER_FIRST + HEADER_LINES; i < lines.size(); i++)
+    {
+        string_view line = lines[i];
+        if (line == "end")
+        {
+            for (size_t j = i + 1; j < lines.size(); j++)
+                if (!lines[j].empty()) return fail(j, "text after end");
+            return true;
+        }
+        if (interrupted)
+            return fail(i, "operation after interrupted");
+        if (line == "interrupted") { interrupted = true; continue; }
+
+        size_t mark = line.find_first_of("=!");
+        string_view command = line.substr(0, mark);
+        size_t space = command.find(' ');
+        string_view op = command.substr(0, space);
+        if (!ParseInts(space == string_view::npos ? string_view() : command.substr(space + 1), args))
+            return fail(i, "invalid arguments");
+        operations++;
+
+        DrawStatus status;
+        if (ReplayDraw(engine, op, args, gen, picked, status))
+        {
+            if (mark == string_view::npos || !ParseInts(line.substr(mark + 1), expected))
+                return fail(i, "missing draw result");
+            bool same = line[mark] == '='
+                ? status == DrawStatus::Ok && picked == expected
+                : status != DrawStatus::Ok && expected.size() == 1 && expected[0] == static_cast<int>(status);
+            if (!same)
+                return fail(i, "draw result differs from replay");
+        }
+        else if (mark != string_view::npos)
+            return fail(i, "unknown draw");
+        else if (op == "clear" && args.empty()) engine.ClearHistory();
+        else if (op == "undo" && args.empty()) { if (!engine.Undo(scratch)) return fail(i, "nothing to undo"); }
+        else if (op == "redo" && args.empty()) { if (!engine.Redo(scratch)) return fail(i, "nothing to redo"); }
+        else if (op == "cooldown" && args.size() == 1 && args[0] >= 0) engine.SetCooldown(static_cast<size_t>(args[0]));
+        else if (op == "exclude" && args.size() == 2) { if (!engine.AddExclusion(args[0], args[1])) return fail(i, "invalid exclusion pair"); }
+        else if (op == "unexclude" && args.empty()) engine.ClearExclusions();
+        else return fail(i, "unknown operation");
+    }
+    return fail(lines.size(), "missing end");
+}
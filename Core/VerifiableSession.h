@@ -0,0 +1,55 @@
+// 可验证抽取（承诺—揭示）：一节课开始时生成 32 字节会话种子，公布承诺值 SHA-256(种子 ‖ 起始头部)，
+// 其中起始头部记下名单快照（含冷却与撤销记录）与互斥约束；课上每次抽取都使用以种子为密钥的 ChaCha20 流，并记下参数与结果。
+// 下课时揭示种子与全部操作（记录文本），任何人都可以用同一份名单离线重放（iccore verify），
+// 核对承诺值、逐次比对抽取结果。会话期间重新导入名单或恢复快照会中断记录，中断之前的部分仍可验证。
+//
+// 记录文本每行一项：
+//   islandcaller-transcript 3
+//   commitment <十六进制>
+//   seed <十六进制>
+//   state <十六进制快照>        ┐ 起始头部（计入承诺值）；快照含冷却与撤销记录
+//   exclusions [a,b ...]        ┘
+//   draw <k> = <下标 ...>  或  draw <k> ! <DrawStatus>
+//   stratified <mode> <k> = ... / spatial <mode> <k> = ...
+//   clear / undo / redo / cooldown <人次> / exclude <a> <b> / unexclude
+//   interrupted（可选）
+//   end
+
+#pragma once
+#include "RandomEngine.h"
+#include <array>
+#include <initializer_list>
+#include <optional>
+
+class VerifiableSession
+{
+public:
+    // 以 engine 当前状态开始会话并返回承诺值（十六进制）；engine 须已导入名单
+    // 冷却与撤销记录原样保留并写入起始头部，重放从同一状态出发，会话中也可以撤销开始之前的抽取
+    std::string Begin(RandomEngine& engine, const std::array<uint8_t, 32>& seed);
+    bool Active() const { return active; }
+    // 会话期间抽取使用的随机数流
+    RandomStream& Stream() { return *stream; }
+
+    // 记录一次抽取（含失败的抽取，失败时同样可能消耗了随机数）或不涉及随机数的操作；会话未进行时忽略
+    void Record(const char* op, std::initializer_list<int> args, DrawStatus status, const std::vector<int>& picked);
+    void Record(const char* op, std::initializer_list<int> args = {});
+    // 名单被替换：停止记录，之后的抽取不再使用会话流
+    void Interrupt();
+
+    // 结束会话，返回记录文本；没有开始过会话时返回空串
+    std::string Reveal();
+
+private:
+    bool active = false;
+    bool begun = false;
+    std::array<uint8_t, 32> seed{};
+    std::string commitment;
+    std::string header;
+    std::string operations;
+    std::optional<RandomStream> stream;
+};
+
+// 重放记录文本：engine 须已按原样导入同一份名单（名单指纹不符时失败）
+// 全部一致时返回 true，operations 为重放的操作数；否则返回 false，error 说明原因与行号
+bool VerifyTranscript(RandomEngine& engine, std::string_view transcript, size_t& operations, std::string& error);
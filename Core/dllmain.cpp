@@ -1,4 +1,5 @@
 ﻿#include "pch.h"
+#ifdef _WIN32
 
 BOOL APIENTRY DllMain(HMODULE hModule, DWORD  ul_reason_for_call, LPVOID lpReserved) {
     switch (ul_reason_for_call) {
@@ -9,4 +10,5 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD  ul_reason_for_call, LPVOID lpReser
         break;
     }
     return TRUE;
-}
\ No newline at end of file
+}
+#endif
@@ -8,19 +8,24 @@
 #define PCH_H
 
 // 添加要在此处预编译的标头
+#ifdef _WIN32
 #include "framework.h"
+#endif
 #include <fstream>
 #include <iostream>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <random>
 #include <ctime>
 #include <sstream>
 #include <iomanip>
+#ifdef _WIN32
 #include <shlobj.h>
 #include <webauthn.h>
 #include <bcrypt.h>
 #include <comutil.h>
+#endif
 #include <locale>
 #include <codecvt>
 #include <unordered_set>
@@ -30,9 +35,14 @@
 #include <cmath>
 #include <mutex>
 #include <algorithm>
+#include "Platform.h"
 #endif //PCH_H
 
 #ifdef EXPORT_DLL
 #else
+#ifdef _WIN32
 #define EXPORT_DLL extern "C" _declspec(dllexport) //导出dll
+#else
+#define EXPORT_DLL extern "C" __attribute__((visibility("default"))) //导出so
+#endif
 #endif
\ No newline at end of file
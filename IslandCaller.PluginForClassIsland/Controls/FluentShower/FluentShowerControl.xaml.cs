@@ -25,5 +25,10 @@ namespace IslandCaller.Controls.FluentShower
             InitializeComponent();
             textblock.Text = name;
         }
+
+        public void SetName(string name)
+        {
+            textblock.Text = name;
+        }
     }
 }
@@ -30,6 +30,7 @@ namespace IslandCaller.Models
                 IsC_SecurityKey_SecretKey = IsC_SecurityKey?.CreateSubKey("SecretKey", writable: true);
 
                 IsC_GeneralKey?.SetValue("BreakDisable", Instance.General.BreakDisable);
+                IsC_GeneralKey?.SetValue("IpcServerEnable", Instance.General.IpcServerEnable);
                 IsC_ProfileKey?.SetValue("ProfileNum", Instance.Profile.ProfileNum);
                 IsC_ProfileKey?.SetValue("DefaultProfileName", Instance.Profile.DefaultProfile.ToString());
                 IsC_ProfileKey?.SetValue("IsPreferProfile", Instance.Profile.IsPreferProfile);
@@ -68,6 +69,7 @@ namespace IslandCaller.Models
                 IsC_SecurityKey_SecretKey = IsC_SecurityKey?.OpenSubKey("SecretKey", writable: true);
 
                 Instance.General.BreakDisable = Convert.ToBoolean(IsC_GeneralKey?.GetValue("BreakDisable") ?? false);
+                Instance.General.IpcServerEnable = Convert.ToBoolean(IsC_GeneralKey?.GetValue("IpcServerEnable") ?? false);
                 Instance.Profile.ProfileNum = Convert.ToInt32(IsC_ProfileKey?.GetValue("ProfileNum") ?? 1);
                 Instance.Profile.DefaultProfile = Guid.Parse(IsC_ProfileKey?.GetValue("DefaultProfileName") as string ?? Guid.Empty.ToString());
                 Instance.Profile.IsPreferProfile = Convert.ToBoolean(IsC_ProfileKey?.GetValue("IsPreferProfile") ?? false);
@@ -99,6 +101,7 @@ namespace IslandCaller.Models
             RegistryKey IsC_SecurityKey_SecretKey = IsC_SecurityKey?.OpenSubKey("SecretKey", writable: true);
 
             IsC_GeneralKey?.SetValue("BreakDisable", Instance.General.BreakDisable);
+            IsC_GeneralKey?.SetValue("IpcServerEnable", Instance.General.IpcServerEnable);
             IsC_ProfileKey?.SetValue("ProfileNum", Instance.Profile.ProfileNum);
             IsC_ProfileKey?.SetValue("DefaultProfileName", Instance.Profile.DefaultProfile.ToString());
             IsC_ProfileKey?.SetValue("IsPreferProfile", Instance.Profile.IsPreferProfile);
@@ -18,6 +18,7 @@ namespace IslandCaller.Models
         {
             _version = "1.0.4.0";
             _breakdisable = false;
+            _ipcserverenable = false;
         }
 
         private string _version;
@@ -33,6 +34,14 @@ namespace IslandCaller.Models
             set { if (_breakdisable != value) { _breakdisable = value; OnPropertyChanged(nameof(BreakDisable)); } }
         }
 
+        // 启用后 Core 在本地命名管道上提供抽取服务，桌面快捷方式可直接连接而不经过 URI 导航
+        private bool _ipcserverenable;
+        public bool IpcServerEnable
+        {
+            get => _ipcserverenable;
+            set { if (_ipcserverenable != value) { _ipcserverenable = value; OnPropertyChanged(nameof(IpcServerEnable)); } }
+        }
+
         public event PropertyChangedEventHandler? PropertyChanged;
         protected void OnPropertyChanged(string name) =>
             PropertyChanged?.Invoke(this, new PropertyChangedEventArgs(name));
@@ -35,6 +35,11 @@ public class Plugin : PluginBase
             {
                 Log.WriteLog("Plugin.cs", "Error", "Profile not found");
             }
+            if (Settings.Instance.General.IpcServerEnable)
+            {
+                if (Core.StartIpcServer(null) == 0) Log.WriteLog("Plugin.cs", "Success", "IPC server started");
+                else Log.WriteLog("Plugin.cs", "Error", "IPC server start failed");
+            }
             string dllPath = Path.Combine(AppDomain.CurrentDomain.BaseDirectory, "Plugins\\Plugin.IslandCaller", "iNKORE.UI.WPF.Modern.Controls");
             if (File.Exists(dllPath))
             {
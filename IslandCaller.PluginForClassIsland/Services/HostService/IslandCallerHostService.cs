@@ -2,7 +2,10 @@
 using ClassIsland.Core.Abstractions.Services;
 using ClassIsland.Shared.Enums;
 using IslandCaller.Models;
+using IslandCaller.PluginForClassIsland.Models;
 using Microsoft.Extensions.Hosting;
+using System.IO;
+using System.Runtime.InteropServices;
 using ControlzEx.Standard;
 using Status = IslandCaller.Models.Status;
 
@@ -21,6 +24,7 @@ namespace IslandCaller.Services.IslandCallerHostService
             {
                 Status.Instance.lessonstatu = lessonsService.CurrentState;
                 Core.ClearHistory();
+                RestartVerifiableSession();
             };
             UriNavigationService.HandlePluginsNavigation(
                 "IslandCaller/Run",
@@ -44,6 +48,56 @@ namespace IslandCaller.Services.IslandCallerHostService
                 }
             );
         }
+
+        // 可验证抽取：每次课间切换时揭示上一节的记录并开始新的会话。
+        // 承诺值在抽取之前追加到 commitments.txt，记录文本存为 Transcripts 下的文件，可用 iccore verify 与名单离线核对
+        // 揭示后种子即被清除，记录只剩这一份：先写出记录再开始新会话；写入失败的内容留在内存中，下次切换时重试
+        private static readonly List<(string Path, string Text, bool Append)> pendingWrites = new();
+
+        private static void RestartVerifiableSession()
+        {
+            string folder = Path.Combine(Plugin.PlugincfgFolder, "Transcripts");
+            string stamp = DateTime.Now.ToString("yyyyMMdd-HHmmss");
+            string transcript = TakeString(Core.EndVerifiableSession());
+            if (transcript.Length > 0)
+                pendingWrites.Add((Path.Combine(folder, stamp + ".txt"), transcript, false));
+            FlushPendingWrites(folder);
+            string commitment = TakeString(Core.BeginVerifiableSession());
+            if (commitment.Length > 0)
+            {
+                pendingWrites.Add((Path.Combine(folder, "commitments.txt"), stamp + " " + commitment + "\n", true));
+                FlushPendingWrites(folder);
+            }
+        }
+
+        private static void FlushPendingWrites(string folder)
+        {
+            try
+            {
+                Directory.CreateDirectory(folder);
+                while (pendingWrites.Count > 0)
+                {
+                    var (path, text, append) = pendingWrites[0];
+                    if (append)
+                        File.AppendAllText(path, text);
+                    else
+                        File.WriteAllText(path, text);
+                    pendingWrites.RemoveAt(0);
+                }
+            }
+            catch (Exception ex) when (ex is IOException || ex is UnauthorizedAccessException)
+            {
+                Log.WriteLog("IslandCallerHostService.cs - RestartVerifiableSession", "Error", $"Failed to save transcript, {pendingWrites.Count} pending, error : {ex.Message}");
+            }
+        }
+
+        private static string TakeString(IntPtr ptr)
+        {
+            string text = Marshal.PtrToStringBSTR(ptr);
+            Marshal.FreeBSTR(ptr);
+            return text;
+        }
+
         public async Task StartAsync(CancellationToken cancellationToken)
         {
         }
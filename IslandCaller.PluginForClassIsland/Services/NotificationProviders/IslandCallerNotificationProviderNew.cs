@@ -25,9 +25,23 @@ public class IslandCallerNotificationProviderNew : NotificationProviderBase
     public async void RandomCall(int stunum)
     {
         if (Settings.Instance.General.BreakDisable & Status.Instance.lessonstatu == TimeState.Breaking) return;
-        IntPtr ptr1 = Core.SimpleRandom(stunum);
-        string output = Marshal.PtrToStringBSTR(ptr1);
+        // 抽取结果与滚动动画由 Core 一次生成，界面每帧只按下标取姓名
+        const int frames = 24;
+        const int rollduration = 1200; // 滚动时长（毫秒）
+        int[] slots = new int[frames * Math.Max(stunum, 1)];
+        int[] times = new int[frames];
+        int result = Core.AnimatedRandom(stunum, frames, rollduration, slots, times, out IntPtr ptr1);
+        string names = Marshal.PtrToStringBSTR(ptr1);
         Marshal.FreeBSTR(ptr1); // 释放分配的 BSTR 内存
+        string[] arena = names.Split('\n'); // 姓名可能含有连续空格，Core 以换行分隔动画名单
+        string output = result == 0 ? string.Join("  ", arena.Take(stunum)) : names;
+        string[] frameTexts = new string[result == 0 ? frames : 1];
+        for (int f = 0; f < frameTexts.Length; f++)
+        {
+            frameTexts[f] = result == 0
+                ? string.Join("  ", Enumerable.Range(0, stunum).Select(s => arena[slots[f * stunum + s]]))
+                : output;
+        }
         int maskduration = stunum * 2 + 1; // 计算持续时间
         ShowNotification(new NotificationRequest()
         {
@@ -39,9 +53,9 @@ public class IslandCallerNotificationProviderNew : NotificationProviderBase
                 SpeechContent = output,
             }
         });
-        var fluentShower = new FluentShower(output);
+        var fluentShower = new FluentShower(frameTexts, times);
         fluentShower.Show();
-        await Task.Delay(maskduration * 1000); // 等待指定的持续时间
+        await Task.Delay(maskduration * 1000 + (result == 0 ? rollduration : 0)); // 等待指定的持续时间
         fluentShower.Close();
     }
 }
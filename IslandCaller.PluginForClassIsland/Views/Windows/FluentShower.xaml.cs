@@ -1,5 +1,6 @@
 ﻿using System;
 using System.Collections.Generic;
+using System.Diagnostics;
 using System.Linq;
 using System.Text;
 using System.Threading.Tasks;
@@ -22,9 +23,16 @@ namespace IslandCaller.Views.Windows
     /// </summary>
     public partial class FluentShower : Window
     {
-        public FluentShower(string name)
+        private readonly Controls.FluentShower.FluentShowerControl control;
+
+        public FluentShower(string name) : this(new[] { name }, new[] { 0 })
         {
-            var control = new Controls.FluentShower.FluentShowerControl(name)
+        }
+
+        // 滚动显示 frameTexts，第 f 帧在 timesMs[f] 毫秒时出现，最后一帧为结果
+        public FluentShower(string[] frameTexts, int[] timesMs)
+        {
+            control = new Controls.FluentShower.FluentShowerControl(frameTexts[0])
             {
                 Height = 95,
                 Margin = new Thickness(20, 0, 25, 0),
@@ -33,7 +41,22 @@ namespace IslandCaller.Views.Windows
             };
             InitializeComponent();
             RootGrid.Children.Add(control);
-            Loaded += (s, e) => Onloaded();
+            Loaded += (s, e) =>
+            {
+                Onloaded();
+                Roll(frameTexts, timesMs);
+            };
+        }
+
+        private async void Roll(string[] frameTexts, int[] timesMs)
+        {
+            var clock = Stopwatch.StartNew();
+            for (int f = 1; f < frameTexts.Length; f++)
+            {
+                int wait = timesMs[f] - (int)clock.ElapsedMilliseconds;
+                if (wait > 0) await Task.Delay(wait);
+                control.SetName(frameTexts[f]);
+            }
         }
         private void Window_SourceInitialized(object sender, EventArgs e)
         {